@@ -0,0 +1,284 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Micro-benchmarks of the TK and TD kernels, samplers, projectors and the loglikelihood.
+ * License GPL-2
+ * 2026-10-19
+ *
+ * Usage: guts_bench_core [--models SD,IT_lognormal,...] [--N 1000,...] [--M 5000,...]
+ *   [--exposure 22,...] [--survival 22,...] [--days 21] [--repeats 10] [--format csv|json]
+ *
+ * Lists of values are swept as a cartesian product. Each benchmark is run once to warm
+ * up and then repeats times; the median and minimum time per operation are reported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "GUTS_RED.h"
+#include "external_data.h"
+
+typedef std::vector<double > tv;
+typedef external_data<tv, tv, true, true > tdata;
+
+namespace {
+
+const char* const all_models = "SD,IT_lognormal,IT_loglogistic,IT_imp_lognormal,IT_imp_loglogistic,Proper_lognormal,Proper_loglogistic";
+
+struct options {
+  std::vector<std::string > models;
+  std::vector<std::size_t > N, M, exposure, survival;
+  double days;
+  std::size_t repeats;
+  bool json;
+};
+
+/// settings of one benchmark; 0 if the benchmark does not depend on a setting
+struct setting {
+  std::string model;
+  std::size_t N, M, exposure, survival;
+};
+
+// keeps results alive, such that benchmarked calls are not optimized away
+volatile double sink = 0;
+
+template<typename T >
+std::vector<T > parse_list(const std::string& s) {
+  std::vector<T > values;
+  std::stringstream ss(s);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    std::stringstream is(item);
+    T v;
+    if (!(is >> v)) throw std::invalid_argument("Cannot parse '" + item + "'.");
+    values.push_back(v);
+  }
+  return values;
+}
+
+options parse_options(int argc, char** argv) {
+  options o;
+  o.models = parse_list<std::string >(all_models);
+  o.N = {1000};
+  o.M = {5000};
+  o.exposure = {22};
+  o.survival = {22};
+  o.days = 21;
+  o.repeats = 10;
+  o.json = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + arg + ".");
+    const std::string value = argv[++i];
+    if (arg == "--models") o.models = parse_list<std::string >(value);
+    else if (arg == "--N") o.N = parse_list<std::size_t >(value);
+    else if (arg == "--M") o.M = parse_list<std::size_t >(value);
+    else if (arg == "--exposure") o.exposure = parse_list<std::size_t >(value);
+    else if (arg == "--survival") o.survival = parse_list<std::size_t >(value);
+    else if (arg == "--days") o.days = std::stod(value);
+    else if (arg == "--repeats") o.repeats = std::stoul(value);
+    else if (arg == "--format") o.json = value == "json";
+    else throw std::invalid_argument("Unknown option " + arg + ".");
+  }
+  return o;
+}
+
+/// equally spaced time points from 0 to days
+tv time_points(const std::size_t n, const double days) {
+  tv t(std::max<std::size_t >(n, 2));
+  for (std::size_t i = 0; i < t.size(); ++i) t[i] = days * static_cast<double >(i) / static_cast<double >(t.size() - 1);
+  return t;
+}
+
+/// pulsed exposure with a fixed seed
+tv exposure_profile(const std::size_t n) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double > conc(0, 10);
+  tv C(std::max<std::size_t >(n, 2));
+  for (std::size_t i = 0; i < C.size(); ++i) C[i] = (rng() % 2 == 0) ? conc(rng) : 0.0;
+  return C;
+}
+
+tdata make_data(const setting& s, const double days) {
+  tdata dat;
+  dat.set_data(time_points(s.exposure, days), exposure_profile(s.exposure), time_points(s.survival, days), s.M, s.N, 1.0);
+  return dat;
+}
+
+void print_header(const options& o) {
+  if (!o.json) std::printf("benchmark,model,N,M,exposure,survival,repeats,ops,median_ns_per_op,min_ns_per_op\n");
+}
+
+std::string field(const std::size_t v) {return v == 0 ? std::string() : std::to_string(v);}
+std::string json_field(const std::size_t v) {return v == 0 ? std::string("null") : std::to_string(v);}
+
+/**
+ * runs f once to warm up and repeats times with timing
+ * \param ops number of operations per call of f
+ */
+template<typename tFunction >
+void run(const options& o, const std::string& benchmark, const setting& s, const std::size_t ops, tFunction f) {
+  f();
+  std::vector<double > ns(o.repeats);
+  for (auto& t : ns) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    t = std::chrono::duration<double, std::nano >(std::chrono::steady_clock::now() - start).count() / static_cast<double >(ops);
+  }
+  std::sort(ns.begin(), ns.end());
+  const double median = ns.empty() ? NAN : ns[ns.size() / 2];
+  const double min = ns.empty() ? NAN : ns.front();
+  if (o.json) {
+    std::printf("{\"benchmark\":\"%s\",\"model\":%s,\"N\":%s,\"M\":%s,\"exposure\":%s,\"survival\":%s,"
+      "\"repeats\":%zu,\"ops\":%zu,\"median_ns_per_op\":%.3f,\"min_ns_per_op\":%.3f}\n",
+      benchmark.c_str(), s.model.empty() ? "null" : ("\"" + s.model + "\"").c_str(),
+      json_field(s.N).c_str(), json_field(s.M).c_str(), json_field(s.exposure).c_str(), json_field(s.survival).c_str(),
+      o.repeats, ops, median, min);
+  } else {
+    std::printf("%s,%s,%s,%s,%s,%s,%zu,%zu,%.3f,%.3f\n", benchmark.c_str(), s.model.c_str(),
+      field(s.N).c_str(), field(s.M).c_str(), field(s.exposure).c_str(), field(s.survival).c_str(),
+      o.repeats, ops, median, min);
+  }
+  std::fflush(stdout);
+}
+
+/// TK_RED::calculate_grid_damage on all grid points
+void bench_TK(const options& o, const setting& s) {
+  external_data<tv, tv, true, false > dat;
+  dat.set_data(time_points(s.exposure, o.days), exposure_profile(s.exposure), time_points(2, o.days), s.M, 1.0);
+  TK_RED<tv, tv > TK;
+  TK.initialize(dat);
+  TK.set_dominant_rate_constant(0.5);
+  TK.initialize_from_parameters();
+  const double dtau = dat.calculate_dtau();
+  run(o, "TK_damage", s, s.M, [&]() {
+    TK_state st;
+    std::size_t k = 0;
+    for (std::size_t j = 0; j < s.M; ++j) {
+      sink = sink + TK.calculate_grid_damage(st, k, dtau * static_cast<double >(j), dtau * static_cast<double >(j + 1));
+    }
+  });
+}
+
+/// imp_*::calc_sample with alternating parameters, such that each call recalculates the sample
+void bench_samplers(const options& o, const setting& s) {
+  imp_lognormal ln;
+  ln.initialize(s.N);
+  ln.set_threshold_sd(2);
+  double mn = 3;
+  run(o, "calc_sample_lognormal", s, 1, [&]() {
+    mn = mn == 3 ? 4 : 3;
+    ln.set_threshold_mean(mn);
+    ln.calc_sample();
+    sink = sink + ln.variate_back();
+  });
+  imp_loglogistic ll;
+  ll.initialize(s.N);
+  ll.set_threshold_beta(3);
+  double alpha = 3;
+  run(o, "calc_sample_loglogistic", s, 1, [&]() {
+    alpha = alpha == 3 ? 4 : 3;
+    ll.set_threshold_alpha(alpha);
+    ll.calc_sample();
+    sink = sink + ll.variate_back();
+  });
+}
+
+/**
+ * TD kernels, projectors and loglikelihood of one model
+ * \tparam TD_mod TD model
+ * \tparam fast_IT whether guts_projector_fastIT applies
+ */
+template<typename TD_mod, bool fast_IT >
+void bench_model(const options& o, const setting& s, const tv& par) {
+  typedef guts_RED<tv, tv, TD_mod, tv > tModel;
+  const tdata dat = make_data(s, o.days);
+
+  // TD kernels on the damage of the grid projection
+  tModel model;
+  model.initialize(dat);
+  model.set_parameters(par);
+  model.initialize_from_parameters();
+  tv D(s.M);
+  {
+    typename tModel::state st;
+    model.set_start_conditions(st);
+    const double dtau = dat.calculate_dtau();
+    std::size_t k = 0;
+    for (std::size_t j = 0; j < s.M; ++j) {
+      D[j] = model.calculate_grid_damage(st.TK, k, dtau * static_cast<double >(j), dtau * static_cast<double >(j + 1));
+    }
+  }
+  run(o, "TD_gather_effect", s, s.M, [&]() {
+    typename tModel::state st;
+    model.TD_mod::set_start_conditions(st.TD);
+    model.update_to_next_survival_measurement(st.TD);
+    for (std::size_t j = 0; j < s.M; ++j) model.gather_effect(st.TD, D[j]);
+    sink = sink + model.calculate_current_survival(st.TD, o.days);
+  });
+
+  guts_projector<tModel, tv, tv > grid;
+  grid.initialize(dat);
+  tv p;
+  run(o, "projector_grid", s, 1, [&]() {
+    p = project(grid, par);
+    sink = sink + p.back();
+  });
+  if (fast_IT) {
+    guts_projector_fastIT<tModel, tv, tv > fast;
+    fast.initialize(dat);
+    run(o, "projector_fastIT", s, 1, [&]() {
+      sink = sink + project(fast, par).back();
+    });
+  }
+
+  tv y(p.size());
+  for (std::size_t i = 0; i < p.size(); ++i) y[i] = std::floor(100 * p[i]);
+  run(o, "loglikelihood", s, 1, [&]() {
+    sink = sink + calculate_loglikelihood(p, y);
+  });
+}
+
+void bench_model(const options& o, const setting& s) {
+  const double nan = std::numeric_limits<double >::quiet_NaN();
+  if (s.model == "SD") bench_model<TD_SD, false >(o, s, {0.01, 0.5, 0.3, 3});
+  else if (s.model == "IT_lognormal") bench_model<TD_IT_lognormal, true >(o, s, {0.01, 0.5, nan, 4, 3});
+  else if (s.model == "IT_loglogistic") bench_model<TD_IT_loglogistic, true >(o, s, {0.01, 0.5, nan, 4, 3});
+  else if (s.model == "IT_imp_lognormal") bench_model<TD_IT_imp_lognormal, true >(o, s, {0.01, 0.5, nan, 4, 3});
+  else if (s.model == "IT_imp_loglogistic") bench_model<TD_IT_imp_loglogistic, true >(o, s, {0.01, 0.5, nan, 4, 3});
+  else if (s.model == "Proper_lognormal") bench_model<TD_proper_lognormal, false >(o, s, {0.01, 0.5, 0.3, 4, 3});
+  else if (s.model == "Proper_loglogistic") bench_model<TD_proper_loglogistic, false >(o, s, {0.01, 0.5, 0.3, 4, 3});
+  else throw std::invalid_argument("Unknown model " + s.model + "; use one of " + all_models + ".");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  try {
+    const options o = parse_options(argc, argv);
+    print_header(o);
+    for (auto N : o.N) bench_samplers(o, {"", N, 0, 0, 0});
+    for (auto M : o.M) {
+      for (auto exposure : o.exposure) bench_TK(o, {"", 0, M, exposure, 0});
+    }
+    for (const auto& model : o.models) {
+      for (auto N : o.N) {
+        for (auto M : o.M) {
+          for (auto exposure : o.exposure) {
+            for (auto survival : o.survival) bench_model(o, {model, N, M, exposure, survival});
+          }
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,11 @@
+# Runs workloads.R and compares with the baseline if it exists.
+set(args --tolerance ${TOLERANCE})
+if(EXISTS ${BASELINE})
+  list(APPEND args --baseline ${BASELINE})
+else()
+  message(STATUS "No workload baseline ${BASELINE}; reporting without comparison.")
+endif()
+execute_process(COMMAND ${RSCRIPT} ${SCRIPT} ${args} RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+  message(FATAL_ERROR "Workload benchmarks failed or regressed.")
+endif()
@@ -150,7 +150,8 @@ struct guts_RED<tt, tC, TD<random_sample<tparam >, 'P' >, tparam > :
 	void set_parameters(const tparam& param) override {
 		set_parameters_hb_kd(*this, param);
 		set_parameters_kk(*this, param);
-		TD_mod::samp.set_variates(param.begin() + 3, param.end());
+		// a threshold sample appended to the parameters replaces the current sample
+		if (param.size() > 3) TD_mod::samp.set_variates(param.begin() + 3, param.end());
 	}
 };
 
@@ -235,21 +236,57 @@ struct guts_RED<tt, tC, TD<random_sample<tparam >, 'I' >, tparam > :
 	}
 	void set_parameters(const tparam& param) override {
 		set_parameters_hb_kd(*this, param);
-		TD_mod::samp.set_variates(param.begin() + 2, param.end());
+		// a threshold sample appended to the parameters replaces the current sample
+		if (param.size() > 2) TD_mod::samp.set_variates(param.begin() + 2, param.end());
 	}
 };
 
+/**
+ * \brief project survival of a parameterized model
+ * \details The projector is not modified. Several threads can run projections
+ * of the same projector concurrently, each with its own state.
+ * \param[in] projector parameterized projector
+ * \param[out] s state of the projection, holds the survival probabilities afterwards
+ */
+template<typename tProjector >
+void run_projection(
+    const tProjector& projector,
+    typename tProjector::state& s) {
+  GUTS_PHASE(projection);
+  projector.set_start_conditions(s);
+  projector.project_survival(s);
+}
+
+/**
+ * \returns TK_RED::is_constant_exposure() for the exposure of data, i.e. whether 
+ * guts_projector_constant_exposure applies
+ */
+template<typename tData >
+bool is_constant_exposure(const tData& data) {
+  TK_RED<typename std::decay<decltype(*data.Ct) >::type, typename std::decay<decltype(*data.C) >::type > TK;
+  TK.initialize(data);
+  return TK.is_constant_exposure();
+}
+
 template<typename tProjector, typename tParameters >
 typename tProjector::tProjection project(
     tProjector& projector,
-    const tParameters& parameters) {
+    const tParameters& parameters,
+    typename tProjector::state& s) {
   typename tProjector::tProjection result;
   projector.set_parameters(parameters);
   projector.initialize_from_parameters();
-  projector.set_start_conditions();
-  projector.project_survival();
-  projector.get_survival_projection(result);
+  run_projection(projector, s);
+  projector.get_survival_projection(s, result);
   return result;
 }
 
+template<typename tProjector, typename tParameters >
+typename tProjector::tProjection project(
+    tProjector& projector,
+    const tParameters& parameters) {
+  typename tProjector::state s;
+  return project(projector, parameters, s);
+}
+
 #endif //GUTS_TD_H
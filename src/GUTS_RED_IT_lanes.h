@@ -0,0 +1,144 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef GUTS_RED_IT_LANES_H
+#define GUTS_RED_IT_LANES_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "random_distributions.h"
+
+/**
+ * \brief GUTS-RED-IT projection of W parameter sets in lockstep
+ * \details Each lane holds one parameter set (hb, kd and the two parameters of the
+ * threshold distribution). All lanes share the exposure and the survival times.
+ * The projection follows guts_projector_fastIT with TK_RED: per survival interval,
+ * damage is evaluated at concentration measurement times, at damage maxima within
+ * concentration intervals and at the survival time; survival follows from the
+ * threshold CDF of the maximum damage. Damage of all lanes is evaluated in the same
+ * loops; maxima that lie outside an interval are masked per lane.
+ * \tparam tt time vector type
+ * \tparam tC concentration vector type
+ * \tparam tDist threshold distribution (loglogistic or lognormal)
+ * \tparam W number of lanes
+ */
+template<typename tt, typename tC, typename tDist, std::size_t W = 4 >
+class guts_RED_IT_lanes {
+public:
+  typedef std::array<double, W > lanes;
+  guts_RED_IT_lanes() : SVR(1) {
+    hb.fill(0); ke_times_SVR.fill(0);
+  }
+  static constexpr std::size_t num_lanes() {return W;}
+  template<typename tData >
+  void initialize(const tData& data) {
+    Ct = data.Ct;
+    C = data.C;
+    yt = data.yt;
+    SVR = data.SVR;
+    diffCCt.resize(Ct->size() - 1);
+    for ( std::size_t i = 1; i < Ct->size(); ++i ) {
+      diffCCt[i-1] = (C->at(i) - C->at(i-1)) / (Ct->at(i) - Ct->at(i-1));
+    }
+  }
+  /**
+   * \brief set parameters (hb, kd, kk, threshold parameters 1 and 2) of one lane; kk is not used
+   */
+  template<typename tparam >
+  void set_parameters(const std::size_t lane, const tparam& param) {
+    hb.at(lane) = param[0];
+    ke_times_SVR.at(lane) = param[1] * SVR;
+    set_threshold_parameters(dist.at(lane), param[3], param[4]);
+  }
+  /**
+   * \brief project survival for all lanes
+   * \param[out] p survival probabilities, one projection per lane
+   */
+  template<typename tSurvival >
+  void project_survival(std::array<tSurvival, W >& p) const {
+    const std::size_t n = yt->size();
+    lanes D, D_k, D_max, F_max;
+    for (std::size_t l = 0; l < W; ++l) {
+      D_k[l] = 0;
+      F_max[l] = 0;
+      p[l].assign(n, 0);
+      p[l][0] = 1;
+    }
+    std::size_t k = 0; //index Ct
+    for (std::size_t ytpos = 1; ytpos < n; ++ytpos) {
+      const double t = yt->at(ytpos);
+      const double t_previous = yt->at(ytpos-1);
+      D_max.fill(-std::numeric_limits<double >::infinity());
+      while (Ct->at(k+1) < t) {
+        gather_damage_maxima(k, std::max(t_previous, Ct->at(k)), Ct->at(k+1), D_k, D_max);
+        calculate_damage(k, Ct->at(k+1), D_k, D);
+        for (std::size_t l = 0; l < W; ++l) {
+          D_max[l] = std::max(D_max[l], D[l]);
+          D_k[l] = D[l];
+        }
+        ++k; // concentration index
+      }
+      gather_damage_maxima(k, std::max(t_previous, Ct->at(k)), t, D_k, D_max);
+      calculate_damage(k, t, D_k, D);
+      for (std::size_t l = 0; l < W; ++l) {
+        F_max[l] = std::max(F_max[l], dist[l].CDF(std::max(D_max[l], D[l])));
+        p[l][ytpos] = p[l][ytpos-1] > 0 ? (1 - F_max[l]) * std::exp( -hb[l] * t ) : 0;
+      }
+    }
+  }
+protected:
+  /**
+   * \brief damage of lane l at time t in concentration interval k, as TK_RED::calculate_damage()
+   */
+  inline double calculate_damage(const std::size_t l, const std::size_t k, const double t, const double D_k) const {
+    const double dt = t - Ct->at(k);
+    const double tmp = std::exp(-ke_times_SVR[l] * dt);
+    const double summand3 = ke_times_SVR[l] > 0.0 ? (dt - (1.0 - tmp) / ke_times_SVR[l]) * diffCCt[k] : 0.0;
+    return tmp * (D_k - C->at(k)) + C->at(k) + summand3;
+  }
+  inline void calculate_damage(const std::size_t k, const double t, const lanes& D_k, lanes& D) const {
+    for (std::size_t l = 0; l < W; ++l) D[l] = calculate_damage(l, k, t, D_k[l]);
+  }
+  /**
+   * \brief raises D_max to the damage maximum within (t_begin, t_end) of concentration interval k, per lane
+   * \details as guts_projector_fastIT with TK_RED::is_maximum_damage() and TK_RED::calculate_time_of_extreme_damage()
+   */
+  inline void gather_damage_maxima(const std::size_t k, const double t_begin, const double t_end, const lanes& D_k, lanes& D_max) const {
+    const double c = C->at(k);
+    const double dC = diffCCt[k];
+    for (std::size_t l = 0; l < W; ++l) {
+      const double te = std::log((D_k[l] - c) * ke_times_SVR[l] / dC + 1) / ke_times_SVR[l] + Ct->at(k);
+      if (D_k[l] < c - dC / ke_times_SVR[l] && te > t_begin && te < t_end) {
+        D_max[l] = std::max(D_max[l], calculate_damage(l, k, te, D_k[l]));
+      }
+    }
+  }
+  static inline void set_threshold_parameters(loglogistic& d, const double alpha, const double beta) {
+    d.set_threshold_alpha(alpha);
+    d.set_threshold_beta(beta);
+  }
+  static inline void set_threshold_parameters(lognormal& d, const double mn, const double sd) {
+    d.set_threshold_mean(mn);
+    d.set_threshold_sd(sd);
+  }
+  std::shared_ptr<const tt > Ct;
+  std::shared_ptr<const tC > C;
+  std::shared_ptr<const tt > yt;
+  std::vector<double > diffCCt;
+  double SVR;
+  lanes hb;
+  lanes ke_times_SVR;
+  std::array<tDist, W > dist;
+};
+
+#endif //GUTS_RED_IT_LANES_H
@@ -0,0 +1,124 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-18
+ */
+
+#ifndef GUTS_RED_SD_LANES_H
+#define GUTS_RED_SD_LANES_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+/**
+ * \brief GUTS-RED-SD projection of W parameter sets in lockstep
+ * \details Each lane holds one parameter set (hb, kd, kk, z). All lanes share
+ * the exposure, the survival times and the time grid. Therefore, the loops over
+ * lanes have no dependencies and are vectorized by the compiler (e.g. four
+ * doubles per AVX register for W = 4).
+ * The time stepping follows guts_projector with TK_RED and TD_SD. Within a
+ * concentration interval the exponential decay of damage is updated
+ * multiplicatively, i.e. an exponential is only evaluated per lane and interval.
+ * \tparam tt time vector type
+ * \tparam tC concentration vector type
+ * \tparam W number of lanes
+ */
+template<typename tt, typename tC, std::size_t W = 4 >
+class guts_RED_SD_lanes {
+public:
+  typedef std::array<double, W > lanes;
+  guts_RED_SD_lanes() : M(0), dtau(std::numeric_limits<double>::quiet_NaN()), SVR(1) {
+    hb.fill(0); ke_times_SVR.fill(0); kk.fill(0); z.fill(0);
+  }
+  static constexpr std::size_t num_lanes() {return W;}
+  template<typename tData >
+  void initialize(const tData& data) {
+    Ct = data.Ct;
+    C = data.C;
+    yt = data.yt;
+    M = data.M;
+    dtau = data.calculate_dtau();
+    SVR = data.SVR;
+    diffCCt.resize(Ct->size() - 1);
+    for ( std::size_t i = 1; i < Ct->size(); ++i ) {
+      diffCCt[i-1] = (C->at(i) - C->at(i-1)) / (Ct->at(i) - Ct->at(i-1));
+    }
+  }
+  /**
+   * \brief set parameters (hb, kd, kk, z) of one lane
+   */
+  template<typename tparam >
+  void set_parameters(const std::size_t lane, const tparam& param) {
+    hb.at(lane) = param[0];
+    ke_times_SVR.at(lane) = param[1] * SVR;
+    kk.at(lane) = param[2];
+    z.at(lane) = param[3];
+  }
+  /**
+   * \brief project survival for all lanes
+   * \param[out] p survival probabilities, one projection per lane
+   */
+  template<typename tSurvival >
+  void project_survival(std::array<tSurvival, W >& p) const {
+    const std::size_t n = yt->size();
+    lanes D, D_k, E, tmp, decay, inv_a, has_a;
+    for (std::size_t l = 0; l < W; ++l) {
+      D[l] = 0;
+      D_k[l] = 0;
+      E[l] = 0;
+      decay[l] = std::exp(-ke_times_SVR[l] * dtau);
+      has_a[l] = ke_times_SVR[l] > 0.0 ? 1.0 : 0.0;
+      inv_a[l] = ke_times_SVR[l] > 0.0 ? 1.0 / ke_times_SVR[l] : 0.0;
+      tmp[l] = 1;
+      p[l].assign(n, 0);
+      p[l][0] = 1;
+    }
+    std::size_t tauit = 0; //index discrete time
+    std::size_t k = 0;     //index Ct
+    double tau = 0;        //discrete absolute time
+    for (std::size_t ytpos = 1; ytpos < n; ++ytpos) {
+      while ( tauit < M && tau < yt->at(ytpos) ) {
+        const double c = C->at(k);
+        const double dC = diffCCt[k];
+        const double dt = tau - Ct->at(k);
+        for (std::size_t l = 0; l < W; ++l) {
+          D[l] = tmp[l] * (D_k[l] - c) + c + (dt - (1.0 - tmp[l]) * inv_a[l]) * dC * has_a[l];
+          E[l] += std::min(z[l] - D[l], 0.0);
+        }
+        tau = dtau * static_cast<double>(++tauit);
+        if (tau > Ct->at(k+1)) {
+          ++k; // concentration index
+          for (std::size_t l = 0; l < W; ++l) {
+            D_k[l] = D[l];
+            tmp[l] = std::exp(-ke_times_SVR[l] * (tau - Ct->at(k)));
+          }
+        } else {
+          for (std::size_t l = 0; l < W; ++l) tmp[l] *= decay[l];
+        }
+      }
+      for (std::size_t l = 0; l < W; ++l) {
+        p[l][ytpos] = std::exp(kk[l] * dtau * E[l] - hb[l] * yt->at(ytpos));
+      }
+    }
+  }
+protected:
+  std::shared_ptr<const tt > Ct;
+  std::shared_ptr<const tC > C;
+  std::shared_ptr<const tt > yt;
+  std::vector<double > diffCCt;
+  std::size_t M;
+  double dtau;
+  double SVR;
+  lanes hb;
+  lanes ke_times_SVR;
+  lanes kk;
+  lanes z;
+};
+
+#endif //GUTS_RED_SD_LANES_H
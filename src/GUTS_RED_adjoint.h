@@ -0,0 +1,454 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef GUTS_RED_ADJOINT_H
+#define GUTS_RED_ADJOINT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "GUTS_RED.h"
+#include "GUTS_RED_simulation.h"
+#include "external_data.h"
+
+/**
+ * Derivatives of survival (or of the log-likelihood) with respect to every concentration
+ * C[k] and every concentration measurement time Ct[k], in reverse mode: the damage is
+ * projected forward once, and the derivatives of the objective with respect to the damage
+ * are propagated backwards through the damage recursion of TK_RED. All derivatives cost
+ * about two projections instead of one projection per concentration.
+ *
+ * SD and Proper models are differentiated on the time grid of guts_projector, i.e. the
+ * derivatives are those of the discretized model. IT models are differentiated at the
+ * damage maxima of guts_projector_fastIT; the time of a maximum moves with the exposure,
+ * but the damage is stationary there, so that only its value contributes. IT models need a
+ * continuous threshold distribution (survival of a threshold sample is piecewise constant).
+ */
+
+/**
+ * \brief damage of TK_RED and its derivatives with respect to the exposure
+ * \details Within concentration interval k, the damage at time t is
+ * $D = e (D_k - C_k) + C_k + \phi s$ with $e = \exp(-a (t - Ct_k))$,
+ * $\phi = t - Ct_k - (1 - e) / a$ and $s = (C_{k+1} - C_k) / (Ct_{k+1} - Ct_k)$,
+ * from the damage D_k at the beginning of the interval (TK_RED::calculate_damage()).
+ */
+class TK_RED_adjoint {
+public:
+  TK_RED_adjoint() : Ct(), C(), diffCCt(), a(0), dtau(0), D(), k_of(), anchor_of() {}
+  template<typename tCt, typename tC >
+  void initialize(const tCt& new_Ct, const tC& new_C, const double ke_times_SVR) {
+    Ct.assign(new_Ct.begin(), new_Ct.end());
+    C.assign(new_C.begin(), new_C.end());
+    diffCCt.resize(Ct.size() - 1);
+    for (std::size_t k = 1; k < Ct.size(); ++k) {
+      diffCCt[k-1] = (C[k] - C[k-1]) / (Ct[k] - Ct[k-1]);
+    }
+    a = ke_times_SVR;
+  }
+  /**
+   * \brief damage at the first J grid points $j \cdot dtau$, as in guts_projector::gather_effect_per_time_step()
+   * \details The damage at the last grid point of a concentration interval starts the next interval.
+   */
+  void project_grid(const double new_dtau, const std::size_t J, std::vector<double >& new_D) {
+    dtau = new_dtau;
+    D.resize(J);
+    k_of.resize(J);
+    anchor_of.resize(J);
+    std::size_t k = 0;
+    std::size_t anchor = J; // damage 0 at time 0
+    double Dk = 0;
+    double tau = 0;
+    for (std::size_t j = 0; j < J; ) {
+      D[j] = damage(k, tau, Dk);
+      k_of[j] = k;
+      anchor_of[j] = anchor;
+      tau = dtau * static_cast<double >(++j);
+      if (tau > Ct[k+1]) {
+        ++k;
+        anchor = j - 1;
+        Dk = D[anchor];
+      }
+    }
+    new_D = D;
+  }
+  /**
+   * \brief derivatives of $\sum_j g_j D_j$ over the grid points of project_grid()
+   * \param[out] dC derivatives with respect to C
+   * \param[out] dCt derivatives with respect to Ct, not calculated if nullptr
+   */
+  void reverse_grid(const std::vector<double >& g, std::vector<double >& dC, std::vector<double >* dCt) const {
+    const std::size_t J = D.size();
+    dC.assign(C.size(), 0.0);
+    if (dCt) dCt->assign(Ct.size(), 0.0);
+    // adjoint of the damage of each grid point, from the grid points that start an interval from it
+    std::vector<double > lambda(g.begin(), g.begin() + J);
+    for (std::size_t j = J; j > 0; --j) {
+      const std::size_t anchor = anchor_of[j-1];
+      const double Dk = anchor < J ? D[anchor] : 0.0;
+      const std::size_t k = k_of[j-1];
+      const double e = add_partials(k, dtau * static_cast<double >(j-1) - Ct[k], Dk, false, lambda[j-1], dC, dCt);
+      if (anchor < J) lambda[anchor] += e * lambda[j-1];
+    }
+  }
+  /**
+   * \brief derivatives of $\sum_i g_i D(t_i)$ with the exact damage at times t (as in guts_projector_fastIT)
+   * \details The damage at each concentration measurement time starts the next interval.
+   * \param[in] t times within [Ct.front(), Ct.back()], independent of Ct (e.g. survival times, or times of damage maxima)
+   */
+  void reverse_at(const std::vector<double >& t, const std::vector<double >& g,
+      std::vector<double >& dC, std::vector<double >* dCt) const {
+    const std::size_t K = Ct.size();
+    dC.assign(K, 0.0);
+    if (dCt) dCt->assign(K, 0.0);
+    std::vector<double > Dk(K, 0.0);
+    for (std::size_t k = 1; k < K; ++k) Dk[k] = damage(k-1, Ct[k], Dk[k-1]);
+    // adjoint of the damage at each concentration measurement time
+    std::vector<double > lambda(K, 0.0);
+    for (std::size_t i = 0; i < t.size(); ++i) {
+      if (g[i] == 0.0 || !(t[i] > Ct.front())) continue;
+      const std::size_t k = std::min<std::size_t >(std::lower_bound(Ct.begin(), Ct.end(), t[i]) - Ct.begin(), K - 1) - 1;
+      lambda[k] += g[i] * add_partials(k, t[i] - Ct[k], Dk[k], false, g[i], dC, dCt);
+    }
+    for (std::size_t k = K - 1; k > 0; --k) {
+      if (lambda[k] == 0.0) continue;
+      lambda[k-1] += lambda[k] * add_partials(k-1, Ct[k] - Ct[k-1], Dk[k-1], true, lambda[k], dC, dCt);
+    }
+  }
+private:
+  inline double damage(const std::size_t k, const double t, const double Dk) const {
+    const double tmp = std::exp(-a * (t - Ct[k]));
+    const double summand3 = a > 0.0 ? (t - Ct[k] - (1.0 - tmp) / a) * diffCCt[k] : 0.0;
+    return tmp * (Dk - C[k]) + C[k] + summand3;
+  }
+  /**
+   * \brief adds lambda times the derivatives of the damage at time Ct[k] + delta with respect to C and Ct
+   * \param[in] Dk damage at the beginning of interval k
+   * \param[in] at_end true if the time is Ct[k+1] (and moves with it)
+   * \returns the derivative of the damage with respect to Dk
+   */
+  inline double add_partials(const std::size_t k, const double delta, const double Dk, const bool at_end,
+      const double lambda, std::vector<double >& dC, std::vector<double >* dCt) const {
+    const double h = Ct[k+1] - Ct[k];
+    const double e = std::exp(-a * delta);
+    const double phi = a > 0.0 ? delta - (1.0 - e) / a : 0.0;
+    dC[k] += lambda * (1.0 - e - phi / h);
+    dC[k+1] += lambda * phi / h;
+    if (dCt) {
+      const double D_delta = a * e * (C[k] - Dk) + (a > 0.0 ? (1.0 - e) * diffCCt[k] : 0.0);
+      const double D_h = -phi * diffCCt[k] / h;
+      (*dCt)[k] -= lambda * (D_delta + D_h);
+      (*dCt)[k+1] += lambda * (at_end ? D_h + D_delta : D_h);
+    }
+    return e;
+  }
+  std::vector<double > Ct;
+  std::vector<double > C;
+  std::vector<double > diffCCt;
+  ///ke times SVR
+  double a;
+  ///step width of the time grid
+  double dtau;
+  ///damage at the grid points
+  std::vector<double > D;
+  ///concentration interval of each grid point
+  std::vector<std::size_t > k_of;
+  ///grid point whose damage starts the interval of each grid point, D.size() for damage 0 at time 0
+  std::vector<std::size_t > anchor_of;
+};
+
+/**
+ * \brief thresholds of the hazard of SD and Proper models
+ * \details Survival until yt[i] is
+ * $e^{-hb\,yt_i} (c + \sum_u \omega_u e^{-kk\,dtau\,X_u(i)}) / (c + \sum_u \omega_u)$,
+ * with $X_u(i)$ the damage above threshold z_u summed over the grid points until yt[i]
+ * (see TD<double, 'S'> and TD_proper.h).
+ */
+struct hazard_thresholds {
+  hazard_thresholds() : z(), omega(), c(0) {}
+  ///sorted thresholds
+  std::vector<double > z;
+  ///weights of the thresholds
+  std::vector<double > omega;
+  ///weight of the threshold at infinity (survival without damage-dependent hazard)
+  double c;
+};
+
+/// the threshold of SD and Proper-delta models
+inline hazard_thresholds fixed_hazard_threshold(const double z) {
+  hazard_thresholds th;
+  th.z.assign(1, z);
+  th.omega.assign(1, 1.0);
+  return th;
+}
+
+/// an importance sample (imp_lognormal, imp_loglogistic) with calculated variates
+template<typename tSampler >
+hazard_thresholds importance_hazard_thresholds(const tSampler& samp) {
+  hazard_thresholds th;
+  for (std::size_t u = 0; u < samp.sample_size(); ++u) {
+    th.z.push_back(samp.variate_at(u));
+    th.omega.push_back(std::exp(samp.weight_at(u)));
+  }
+  return th;
+}
+
+/**
+ * \brief a sorted random sample with probability weights w, or unweighted if w is empty
+ * \details As in TD<random_sample, 'P'>, the threshold at infinity has the weight 1/n of one
+ * variate of the raw sample of size n.
+ */
+template<typename tz >
+hazard_thresholds sample_hazard_thresholds(const tz& z, const tz& w, const double n) {
+  hazard_thresholds th;
+  th.z.assign(z.begin(), z.end());
+  if (w.size() > 0) {
+    th.omega.assign(w.begin(), w.end());
+  } else {
+    th.omega.assign(z.size(), 1 / n);
+  }
+  th.c = 1 / n;
+  return th;
+}
+
+/**
+ * \brief survival of SD and Proper models on the time grid and its derivatives with respect to the damage
+ */
+class hazard_adjoint {
+public:
+  hazard_adjoint() : kkXdtau(0), z(), D(), terms(), interval(), S() {}
+  /**
+   * \param[in] new_D damage at the grid points $j \cdot dtau$
+   */
+  void initialize(const std::vector<double >& new_D, const double dtau, const std::vector<double >& yt,
+      const double kk, const double hb, const hazard_thresholds& th) {
+    const std::size_t T = yt.size();
+    const std::size_t N = th.z.size();
+    kkXdtau = kk * dtau;
+    z = th.z;
+    D = new_D;
+    hazard_mortality excess;
+    excess.initialize(D, dtau, yt, kk, hb);
+    grid_intervals(D.size(), dtau, yt, interval);
+    double P = th.c;
+    for (std::size_t u = 0; u < N; ++u) P += th.omega[u];
+    // terms[i * N + u]: contribution of threshold u to survival until yt[i]
+    terms.assign(T * N, 0.0);
+    for (std::size_t u = 0; u < N; ++u) {
+      double X = 0;
+      for (std::size_t i = 0; i < T; ++i) {
+        if (i > 0) X += excess.damage_excess(i, z[u]);
+        terms[i * N + u] = th.omega[u] * std::exp(-kkXdtau * X - hb * yt[i]) / P;
+      }
+    }
+    S.assign(T, 0.0);
+    for (std::size_t i = 0; i < T; ++i) {
+      double Si = th.c * std::exp(-hb * yt[i]) / P;
+      for (std::size_t u = 0; u < N; ++u) Si += terms[i * N + u];
+      S[i] = Si;
+    }
+  }
+  inline const std::vector<double >& survival() const {return S;}
+  /**
+   * \brief derivatives of $\sum_i w_i S_i$ with respect to the damage at the grid points
+   */
+  void damage_gradient(const std::vector<double >& w, std::vector<double >& g) const {
+    const std::size_t T = S.size();
+    const std::size_t N = z.size();
+    // R[m * (N + 1) + u]: sum of w_i times the terms of the thresholds below u over the survival times from m
+    std::vector<double > R(T * (N + 1), 0.0);
+    std::vector<double > tail(N, 0.0);
+    for (std::size_t m = T - 1; m > 0; --m) {
+      double prefix = 0;
+      for (std::size_t u = 0; u < N; ++u) {
+        tail[u] += w[m] * terms[m * N + u];
+        R[m * (N + 1) + u] = prefix;
+        prefix += tail[u];
+      }
+      R[m * (N + 1) + N] = prefix;
+    }
+    g.resize(interval.size());
+    for (std::size_t j = 0; j < interval.size(); ++j) {
+      const std::size_t u = std::lower_bound(z.begin(), z.end(), D[j]) - z.begin();
+      g[j] = -kkXdtau * R[interval[j] * (N + 1) + u];
+    }
+  }
+private:
+  double kkXdtau;
+  std::vector<double > z;
+  ///damage at the grid points
+  std::vector<double > D;
+  std::vector<double > terms;
+  ///survival interval of each grid point
+  std::vector<std::size_t > interval;
+  std::vector<double > S;
+};
+
+/**
+ * \brief survival of IT models with a continuous threshold distribution and its derivatives with respect to the maximum damage
+ * \details Survival until yt[i] is $(1 - F(D_{max}(i))) e^{-hb\,yt_i}$ as in TD_IT_CDF.
+ * \tparam tDist threshold distribution with CDF() and PDF() (lognormal, loglogistic)
+ */
+template<typename tDist >
+class tolerance_adjoint {
+public:
+  tolerance_adjoint() : dist(), Dmax(), tmax(), Hb(), S() {}
+  /**
+   * \param[in] D damage at the times Dt (ascending), including damage maxima
+   */
+  void initialize(const std::vector<double >& D, const std::vector<double >& Dt, const std::vector<double >& yt,
+      const double hb, const tDist& new_dist) {
+    dist = new_dist;
+    const std::size_t T = yt.size();
+    Dmax.assign(T, 0.0);
+    tmax.assign(T, 0.0);
+    Hb.assign(T, 0.0);
+    S.assign(T, 0.0);
+    double M = 0;
+    double tM = 0;
+    std::size_t l = 0;
+    for (std::size_t i = 0; i < T; ++i) {
+      for (; l < D.size() && Dt[l] <= yt[i]; ++l) {
+        if (D[l] > M) {
+          M = D[l];
+          tM = Dt[l];
+        }
+      }
+      Dmax[i] = M;
+      tmax[i] = tM;
+      Hb[i] = std::exp(-hb * yt[i]);
+      S[i] = (1 - (M > 0 ? dist.CDF(M) : 0.0)) * Hb[i];
+    }
+  }
+  inline const std::vector<double >& survival() const {return S;}
+  /**
+   * \brief derivatives of $\sum_i w_i S_i$ with respect to the maximum damage until each survival time
+   * \param[out] t times of the maximum damage
+   */
+  void damage_gradient(const std::vector<double >& w, std::vector<double >& t, std::vector<double >& g) const {
+    t = tmax;
+    g.assign(S.size(), 0.0);
+    for (std::size_t i = 0; i < S.size(); ++i) {
+      if (w[i] != 0.0) g[i] = -w[i] * dist.PDF(Dmax[i]) * Hb[i];
+    }
+  }
+private:
+  tDist dist;
+  ///maximum damage until each survival time
+  std::vector<double > Dmax;
+  ///time of the maximum damage
+  std::vector<double > tmax;
+  ///background survival at each survival time
+  std::vector<double > Hb;
+  std::vector<double > S;
+};
+
+enum class survival_objective {final_survival, loglikelihood};
+
+/**
+ * \brief calculates the objective and its derivatives w with respect to the survival S
+ * \details Derivatives of the log-likelihood are NaN if it is -Inf.
+ * \param[in] y survivors (loglikelihood only)
+ */
+template<typename tmeasured_survivors >
+double survival_objective_weights(const survival_objective objective, const std::vector<double >& S,
+    const tmeasured_survivors& y, std::vector<double >& w) {
+  const std::size_t T = S.size();
+  w.assign(T, 0.0);
+  if (objective == survival_objective::final_survival) {
+    w[T-1] = 1;
+    return S[T-1];
+  }
+  const double LL = calculate_loglikelihood(S, y);
+  if (std::isinf(LL)) {
+    w.assign(T, std::numeric_limits<double >::quiet_NaN());
+    return LL;
+  }
+  if (y[T-1] > 0) w[T-1] = static_cast<double >(y[T-1]) / S[T-1];
+  for (std::size_t i = 1; i < T; ++i) {
+    if (y[i-1] > y[i]) {
+      const double d = static_cast<double >(y[i-1] - y[i]) / (S[i-1] - S[i]);
+      w[i-1] += d;
+      w[i] -= d;
+    }
+  }
+  // survival at the first survival time is 1 and independent of the exposure
+  w[0] = 0;
+  return LL;
+}
+
+/**
+ * \brief objective with survival and derivatives with respect to the exposure
+ */
+struct exposure_sensitivity {
+  exposure_sensitivity() : value(std::numeric_limits<double >::quiet_NaN()), S(), dC(), dCt() {}
+  double value;
+  std::vector<double > S;
+  ///derivatives with respect to the concentrations C
+  std::vector<double > dC;
+  ///derivatives with respect to the concentration measurement times Ct, empty if not calculated
+  std::vector<double > dCt;
+};
+
+/**
+ * \brief sensitivity of an SD or Proper model with thresholds th (on the time grid of data)
+ */
+template<typename tt, typename tc, bool add_distribution_sample_size, typename tmeasured_survivors >
+void hazard_exposure_sensitivity(
+    const external_data<tt, tc, true, add_distribution_sample_size >& data,
+    const double kd, const double kk, const double hb, const hazard_thresholds& th,
+    const survival_objective objective, const tmeasured_survivors& y, const bool with_Ct,
+    exposure_sensitivity& res) {
+  const std::vector<double > yt(data.yt->begin(), data.yt->end());
+  const double dtau = data.calculate_dtau();
+  std::size_t J = 0;
+  while (J < data.M && dtau * static_cast<double >(J) < yt.back()) ++J;
+  TK_RED_adjoint TK;
+  TK.initialize(*data.Ct, *data.C, kd * data.SVR);
+  std::vector<double > D;
+  TK.project_grid(dtau, J, D);
+  hazard_adjoint TD;
+  TD.initialize(D, dtau, yt, kk, hb, th);
+  res.S = TD.survival();
+  std::vector<double > w;
+  res.value = survival_objective_weights(objective, res.S, y, w);
+  std::vector<double > g;
+  TD.damage_gradient(w, g);
+  TK.reverse_grid(g, res.dC, with_Ct ? &res.dCt : nullptr);
+  if (!with_Ct) res.dCt.resize(0);
+}
+
+/**
+ * \brief sensitivity of an IT model with threshold distribution dist (at the damage maxima)
+ */
+template<typename tt, typename tc, bool add_time_discretization, bool add_distribution_sample_size,
+  typename tDist, typename tmeasured_survivors >
+void tolerance_exposure_sensitivity(
+    const external_data<tt, tc, add_time_discretization, add_distribution_sample_size >& data,
+    const double kd, const double hb, const tDist& dist,
+    const survival_objective objective, const tmeasured_survivors& y, const bool with_Ct,
+    exposure_sensitivity& res) {
+  typedef std::vector<double > tv;
+  tv D, Dt;
+  damage_maxima(data, kd, D, Dt);
+  const tv yt(data.yt->begin(), data.yt->end());
+  tolerance_adjoint<tDist > TD;
+  TD.initialize(D, Dt, yt, hb, dist);
+  res.S = TD.survival();
+  tv w;
+  res.value = survival_objective_weights(objective, res.S, y, w);
+  tv t, g;
+  TD.damage_gradient(w, t, g);
+  TK_RED_adjoint TK;
+  TK.initialize(*data.Ct, *data.C, kd * data.SVR);
+  TK.reverse_at(t, g, res.dC, with_Ct ? &res.dCt : nullptr);
+  if (!with_Ct) res.dCt.resize(0);
+}
+
+#endif //GUTS_RED_ADJOINT_H
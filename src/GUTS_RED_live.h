@@ -0,0 +1,143 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef GUTS_RED_LIVE_H
+#define GUTS_RED_LIVE_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "helpers.h"
+#include "external_data_def_and_checks.h"
+
+/**
+ * \brief projection of a running study, to which new measurements are appended
+ * \details The projector keeps its data, its projection state and the sum of the
+ * log-likelihood terms of all completed survival intervals. Appending exposure
+ * and survival measurements continues the TK and TD state from the last survival
+ * time and adds the log-likelihood terms of the new intervals only, i.e. the cost
+ * of an update depends on the appended data, not on the length of the study.
+ *
+ * On the time grid, the step width of the first projection is kept, and the grid
+ * is extended with the data (see guts_projector::extend_data()).
+ *
+ * \tparam tProjector resumable projector (guts_projector or guts_projector_fastIT)
+ *   with std::vector<double > times and concentrations
+ * \tparam tData data type of the projector
+ */
+template<typename tProjector, typename tData >
+class guts_live_projector {
+public:
+  typedef std::vector<double > tvalues;
+  guts_live_projector() : LL_intervals(0) {}
+  virtual ~guts_live_projector() {}
+  /**
+   * \brief parameterizes the model and projects the initial data
+   * \param[in] data exposure, survival times, discretizations and SVR (checked by the caller)
+   * \param[in] survivors numbers of survivors at the survival times of data
+   * \param[in] parameters model parameters
+   * \param[in] setup called with the projector before parameterization (e.g. to set an external threshold sample)
+   */
+  template<typename tParameters, typename tSetup >
+  void initialize(const tData& data, const tvalues& survivors, const tParameters& parameters, const tSetup& setup) {
+    if (survivors.size() != data.yt_size()) {
+      throw std::invalid_argument("Need one number of survivors per survival time.");
+    }
+    dat = data;
+    // own copies of the data, which are extended by append()
+    dat.Ct = std::make_shared<tvalues >(*data.Ct);
+    dat.C = std::make_shared<tvalues >(*data.C);
+    dat.yt = std::make_shared<tvalues >(*data.yt);
+    y = survivors;
+    proj.initialize(dat);
+    setup(proj);
+    proj.set_parameters(parameters);
+    proj.initialize_from_parameters();
+    proj.set_start_conditions(st);
+    proj.start_projection(st);
+    LL_intervals = 0;
+    continue_projection(1);
+  }
+  /**
+   * \brief appends measurements and continues the projection
+   * \details Exposure must continue after the last concentration measurement time
+   * and survival after the last survival time. Either may be empty, e.g. if
+   * exposure is known ahead of survival. Exposure must not end before survival.
+   * \throws std::invalid_argument if the appended data do not continue the data
+   */
+  void append(const tvalues& Ct, const tvalues& C, const tvalues& yt, const tvalues& survivors) {
+    check_continuation(*dat.Ct, Ct, C.size(), "Concentration");
+    check_continuation(*dat.yt, yt, survivors.size(), "Survival");
+    throw_invalid_argument_if_contains_nan_or_is_below_0(C, "Concentration");
+    throw_invalid_argument_if_contains_nan_or_is_below_0(survivors, "Survival");
+    const double Ct_end = Ct.empty() ? back(*dat.Ct) : back(Ct);
+    if (!yt.empty() && back(yt) > Ct_end) {
+      throw std::invalid_argument("Exposure must not end earlier than survival.");
+    }
+    const std::size_t ytpos = dat.yt->size();
+    dat.Ct->insert(dat.Ct->end(), Ct.begin(), Ct.end());
+    dat.C->insert(dat.C->end(), C.begin(), C.end());
+    dat.yt->insert(dat.yt->end(), yt.begin(), yt.end());
+    y.insert(y.end(), survivors.begin(), survivors.end());
+    proj.extend_data();
+    proj.extend_projection(st);
+    continue_projection(ytpos);
+  }
+  inline const tData& data() const {return dat;}
+  inline const tvalues& survivors() const {return y;}
+  inline const typename tProjector::tProjection& survival() const {return st.p;}
+  /**
+   * \returns the log-likelihood of all survivors (see calculate_loglikelihood())
+   */
+  double loglikelihood() const {
+    const double y_end = back(y);
+    if (y_end > 0) {
+      const double S_end = back(st.p);
+      if (S_end == 0.0) return -std::numeric_limits<double >::infinity();
+      return LL_intervals + y_end * std::log(S_end);
+    }
+    return LL_intervals;
+  }
+protected:
+  /// projects the survival times from ytpos on and adds their log-likelihood terms
+  void continue_projection(const std::size_t ytpos) {
+    proj.continue_projection(st, dat.yt->size());
+    for (std::size_t i = ytpos; i < y.size(); ++i) {
+      const double diffy = y[i-1] - y[i];
+      if (diffy > 0) {
+        const double diffS = st.p[i-1] - st.p[i];
+        LL_intervals += diffS == 0.0 ? -std::numeric_limits<double >::infinity() : diffy * std::log(diffS);
+      }
+    }
+  }
+  static void check_continuation(const tvalues& times, const tvalues& new_times, const std::size_t num_values, const std::string& lable) {
+    if (new_times.size() != num_values) {
+      throw std::invalid_argument(lable + ": need one value per appended time point.");
+    }
+    double t = back(times);
+    for (auto new_t : new_times) {
+      if (std::isnan(new_t) || !(new_t > t)) {
+        throw std::invalid_argument(lable + ": appended times must be in ascending order after the last time point.");
+      }
+      t = new_t;
+    }
+  }
+  tProjector proj;
+  typename tProjector::state st;
+  tData dat;
+  ///numbers of survivors
+  tvalues y;
+  ///sum of the log-likelihood terms of all survival intervals
+  double LL_intervals;
+};
+
+#endif //GUTS_RED_LIVE_H
@@ -0,0 +1,354 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-18
+ */
+
+#ifndef GUTS_RED_PROFILES_H
+#define GUTS_RED_PROFILES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "helpers.h"
+#include "GUTS_base.h"
+#include "GUTS_RED.h"
+#include "exposure_profiles.h"
+
+/**
+ * \brief replaces the exposure of a parameterized projector
+ * \details data must be the data the projector was initialized with; its exposure 
+ * spans are replaced and the TK model is re-initialized. Parameters are kept.
+ */
+template<typename tProjector, typename tData >
+void set_exposure(tProjector& proj, tData& data, const value_span& Ct, const value_span& C) {
+  *data.Ct = Ct;
+  *data.C = C;
+  static_cast<typename tProjector::TK_mod& >(proj).initialize(data);
+}
+
+/**
+ * \brief multiplication factor of the exposure that reduces relative survival by x percent
+ * \details As damage is linear in the exposure, survival decreases monotonically with 
+ * the factor. The factor is bracketed by doubling (halving) and found by bisection on 
+ * its logarithm.
+ * \param[in] relative_survival callable returning the survival relative to the control for a factor
+ * \param[in] x effect level in percent
+ * \param[in] S_1 relative survival with factor 1
+ * \param[in] rel_tol relative precision of the factor
+ * \returns the factor, infinity if the effect is not reached with factors up to 1e12, 
+ * 0 if it is reached with factors down to 1e-12, NaN if x is not in (0, 100)
+ */
+template<typename tRelativeSurvival >
+double find_LPx(const tRelativeSurvival& relative_survival, const double x, const double S_1, const double rel_tol) {
+  if (!(x > 0.0 && x < 100.0)) return std::numeric_limits<double >::quiet_NaN();
+  const double target = 1.0 - x / 100.0;
+  const double max_log_MF = std::log(1e12);
+  double lo = 0.0;  // log factors with relative survival above target
+  double hi = 0.0;  // log factors with relative survival at or below target
+  if (S_1 > target) {
+    do {
+      lo = hi;
+      hi += std::log(2.0);
+      if (hi > max_log_MF) return std::numeric_limits<double >::infinity();
+    } while (relative_survival(std::exp(hi)) > target);
+  } else {
+    do {
+      hi = lo;
+      lo -= std::log(2.0);
+      if (lo < -max_log_MF) return 0.0;
+    } while (relative_survival(std::exp(lo)) <= target);
+  }
+  while (hi - lo > rel_tol) {
+    const double mid = 0.5 * (lo + hi);
+    if (relative_survival(std::exp(mid)) > target) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return std::exp(0.5 * (lo + hi));
+}
+
+/**
+ * \brief projects survival of many exposure profiles with one parameterized model
+ * \details All profiles share the survival times yt, the time discretization and
+ * the parameters. Each thread holds one projector, one projection state and one
+ * data set, which are reused for all profiles of the thread. Only the exposure
+ * (and thus the TK part of the model) changes between profiles.
+ *
+ * Optionally, the exposure multiplication factors LPx are calculated per profile,
+ * i.e. the factors by which the profile must be multiplied to reduce survival at
+ * the last survival time by x percent relative to the control (background mortality
+ * only). As damage is linear in the exposure, survival decreases monotonically with
+ * the factor and LPx is found by bisection on the logarithm of the factor.
+ *
+ * Profiles are not copied: the exposure of a projector refers to the times and
+ * concentrations of the profile (e.g. in a memory-mapped exposure_store). Only 
+ * multiplied concentrations for LPx are written to a buffer of the thread.
+ *
+ * Profiles with constant exposure are projected with the closed-form solutions of
+ * guts_projector_constant_exposure, as separate projections are.
+ *
+ * \tparam tProjector projector type on value_span data
+ * \tparam tData data type of the projector with value_span times and concentrations
+ */
+template<typename tProjector, typename tData >
+class guts_profile_projector {
+public:
+  typedef typename tProjector::TK_mod TK_mod;
+  guts_profile_projector() : num_threads(1), LPx_rel_tol(1e-6) {}
+  virtual ~guts_profile_projector() {}
+  inline void set_num_threads(const std::size_t new_num_threads) {num_threads = new_num_threads > 0 ? new_num_threads : 1;}
+  inline void set_LPx_tolerance(const double rel_tol) {LPx_rel_tol = rel_tol;}
+  /**
+   * \brief creates one parameterized projector per thread
+   * \param[in] data survival times, discretizations and SVR shared by all profiles, with a valid 
+   * exposure (e.g. the first profile), which is replaced per profile
+   * \param[in] parameters model parameters
+   * \param[in] setup called with each projector before parameterization (e.g. to set an external threshold sample)
+   */
+  template<typename tParameters, typename tSetup >
+  void initialize(const tData& data, const tParameters& parameters, const tSetup& setup) {
+    workspaces.clear();
+    for (std::size_t t = 0; t < num_threads; ++t) {
+      std::unique_ptr<workspace > ws(new workspace());
+      ws->data = data;
+      // separate exposure vectors per thread, the projector refers to them
+      ws->data.Ct = std::make_shared<value_span >(*data.Ct);
+      ws->data.C = std::make_shared<value_span >(*data.C);
+      ws->proj.initialize(ws->data);
+      setup(ws->proj);
+      ws->proj.set_parameters(parameters);
+      ws->proj.initialize_from_parameters();
+      ws->constant_proj.initialize(ws->data);
+      setup(ws->constant_proj);
+      ws->constant_proj.set_parameters(parameters);
+      ws->constant_proj.initialize_from_parameters();
+      workspaces.push_back(std::move(ws));
+    }
+    hb = parameters[static_cast<std::size_t >(tProjector::position::hb)];
+    t_end = back(*data.yt);
+  }
+  /**
+   * \brief projects all profiles
+   * \param[in] profiles exposure profiles (checked with exposure_profiles::check())
+   * \param[in] x effect levels in percent for LPx (may be empty)
+   * \param[out] S survival probabilities, column-major with one row per profile (profiles.size() * yt.size() values)
+   * \param[out] LPx multiplication factors, column-major with one row per profile (profiles.size() * x.size() values)
+   */
+  void project(const exposure_profiles& profiles, const std::vector<double >& x, double* S, double* LPx) {
+    const std::size_t P = profiles.size();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(threads_for(P))
+#endif
+    for (int i = 0; i < static_cast<int >(P); ++i) {
+      int t = 0;
+#ifdef _OPENMP
+      t = omp_get_thread_num();
+#endif
+      workspace& ws = *workspaces[t];
+      set_exposure(ws, profiles, i, 1.0);
+      const typename tProjector::tProjection& p = run_projection(ws);
+      const std::size_t n = p.size();
+      for (std::size_t j = 0; j < n; ++j) S[i + j * P] = p[j];
+      const double S_end = p[n - 1];
+      for (std::size_t l = 0; l < x.size(); ++l) {
+        LPx[i + l * P] = calculate_LPx(ws, profiles, i, x[l], S_end);
+      }
+    }
+  }
+protected:
+  typedef typename constant_exposure_projector<tProjector >::type tConstantProjector;
+  struct workspace {
+    tProjector proj;
+    typename tProjector::state st;
+    ///projector and state for constant exposure
+    tConstantProjector constant_proj;
+    typename tConstantProjector::state constant_st;
+    tData data;
+    ///multiplied concentrations
+    std::vector<double > C_MF;
+  };
+  /// number of threads for P profiles
+  inline int threads_for(const std::size_t P) const {
+    return static_cast<int >(std::max<std::size_t >(std::min(workspaces.size(), P), 1));
+  }
+  /// sets profile i multiplied by MF as exposure of the workspace
+  void set_exposure(workspace& ws, const exposure_profiles& profiles, const std::size_t i, const double MF) const {
+    const value_span C = profiles.concentrations(i);
+    if (MF == 1.0) {
+      ::set_exposure(ws.proj, ws.data, profiles.times(i), C);
+    } else {
+      ws.C_MF.resize(C.size());
+      for (std::size_t k = 0; k < C.size(); ++k) ws.C_MF[k] = MF * C[k];
+      ::set_exposure(ws.proj, ws.data, profiles.times(i), value_span(ws.C_MF.data(), ws.C_MF.size()));
+    }
+    static_cast<TK_mod& >(ws.constant_proj).initialize(ws.data);
+  }
+  /// projects the exposure of the workspace, with the closed-form solutions if it is constant
+  const typename tProjector::tProjection& run_projection(workspace& ws) const {
+    if (ws.constant_proj.is_constant_exposure()) {
+      ::run_projection(ws.constant_proj, ws.constant_st);
+      return ws.constant_st.p;
+    }
+    ::run_projection(ws.proj, ws.st);
+    return ws.st.p;
+  }
+  /// survival at the last survival time relative to the control
+  double relative_survival(workspace& ws, const exposure_profiles& profiles, const std::size_t i, const double MF) const {
+    set_exposure(ws, profiles, i, MF);
+    return back(run_projection(ws)) / std::exp(-hb * t_end);
+  }
+  double calculate_LPx(workspace& ws, const exposure_profiles& profiles, const std::size_t i, const double x, const double S_1) const {
+    return find_LPx(
+      [this, &ws, &profiles, i](const double MF) {return relative_survival(ws, profiles, i, MF);},
+      x, S_1 / std::exp(-hb * t_end), LPx_rel_tol
+    );
+  }
+  std::vector<std::unique_ptr<workspace > > workspaces;
+  std::size_t num_threads;
+  double LPx_rel_tol;
+  double hb;
+  double t_end;
+};
+
+/**
+ * \brief projects survival of exposure scenarios that share leading parts
+ * \details Scenarios are exposure profiles that are identical up to some time 
+ * (e.g. an intervention) and diverge afterwards. They are arranged in a prefix 
+ * tree of their concentration measurements (Ct, C). The projection of a common 
+ * prefix is done once; its state is a checkpoint from which each branch continues.
+ * A prefix of K measurements is projected up to the last survival time at or 
+ * before Ct[K-1]. The cost scales with the size of the tree instead of the number 
+ * of scenarios times the duration. Identical scenarios are projected once.
+ * 
+ * Projections are exactly those of separate projections of the scenarios.
+ * \tparam tProjector projector type on value_span data (resumable, e.g. guts_projector or guts_projector_fastIT)
+ * \tparam tData data type of the projector with value_span times and concentrations
+ */
+template<typename tProjector, typename tData >
+class guts_scenario_projector {
+public:
+  typedef typename tProjector::state state;
+  guts_scenario_projector() : proj(), data(), num_intervals(0) {}
+  virtual ~guts_scenario_projector() {}
+  /**
+   * \brief parameterizes the projector
+   * \param[in] new_data survival times, discretizations and SVR shared by all scenarios, with a valid 
+   * exposure (e.g. the first scenario)
+   * \param[in] parameters model parameters
+   * \param[in] setup called with the projector before parameterization (e.g. to set an external threshold sample)
+   */
+  template<typename tParameters, typename tSetup >
+  void initialize(const tData& new_data, const tParameters& parameters, const tSetup& setup) {
+    data = new_data;
+    data.Ct = std::make_shared<value_span >(*new_data.Ct);
+    data.C = std::make_shared<value_span >(*new_data.C);
+    proj.initialize(data);
+    setup(proj);
+    proj.set_parameters(parameters);
+    proj.initialize_from_parameters();
+  }
+  /**
+   * \brief projects all scenarios
+   * \param[in] scenarios exposure profiles (checked with exposure_profiles::check())
+   * \param[out] S survival probabilities, column-major with one row per scenario
+   */
+  void project(const exposure_profiles& scenarios, double* S) {
+    const std::size_t P = scenarios.size();
+    num_intervals = 0;
+    if (P == 0) return;
+    order.resize(P);
+    for (std::size_t i = 0; i < P; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&scenarios](const std::size_t i, const std::size_t j) {
+      return compare(scenarios, i, j) < 0;
+    });
+    lcp.assign(P, 0);
+    for (std::size_t r = 1; r < P; ++r) lcp[r] = common_prefix(scenarios, order[r-1], order[r]);
+    state s;
+    proj.set_start_conditions(s);
+    proj.start_projection(s);
+    branch(scenarios, 0, P, 0, s, S);
+  }
+  /// number of survival intervals projected by the last call of project()
+  inline std::size_t num_projected_intervals() const {return num_intervals;}
+protected:
+  /// projects the scenarios order[a], ..., order[b-1], which share K measurements and have been projected up to s
+  void branch(const exposure_profiles& scenarios, const std::size_t a, const std::size_t b, const std::size_t K, state& s, double* S) {
+    const std::size_t P = scenarios.size();
+    const std::size_t n = data.yt->size();
+    if (b - a == 1) {
+      const std::size_t i = order[a];
+      if (a > 0 && lcp[a] == scenarios.times(i).size() && lcp[a] == scenarios.times(order[a-1]).size()) {
+        for (std::size_t j = 0; j < n; ++j) S[i + j * P] = S[order[a-1] + j * P];
+        return;
+      }
+      advance(scenarios, i, n, s);
+      for (std::size_t j = 0; j < n; ++j) S[i + j * P] = s.p[j];
+      return;
+    }
+    const std::size_t L = *std::min_element(lcp.begin() + a + 1, lcp.begin() + b);
+    if (L > K) {
+      const value_span Ct = scenarios.times(order[a]);
+      const std::size_t ytpos_end = std::upper_bound(data.yt->begin(), data.yt->end(), Ct[L-1]) - data.yt->begin();
+      advance(scenarios, order[a], ytpos_end, s);
+    }
+    std::size_t first = a;
+    for (std::size_t r = a + 1; r <= b; ++r) {
+      if (r == b || lcp[r] == L) {
+        if (r == b) {
+          branch(scenarios, first, r, L, s, S);
+        } else {
+          state checkpoint(s);
+          branch(scenarios, first, r, L, checkpoint, S);
+        }
+        first = r;
+      }
+    }
+  }
+  /// continues the projection of s with the exposure of scenario i up to survival index ytpos_end
+  void advance(const exposure_profiles& scenarios, const std::size_t i, const std::size_t ytpos_end, state& s) {
+    if (s.ytpos >= ytpos_end) return;
+    const std::size_t ytpos = s.ytpos;
+    set_exposure(proj, data, scenarios.times(i), scenarios.concentrations(i));
+    proj.continue_projection(s, ytpos_end);
+    num_intervals += s.ytpos - ytpos;
+  }
+  /// number of equal leading measurements of scenarios i and j
+  static std::size_t common_prefix(const exposure_profiles& scenarios, const std::size_t i, const std::size_t j) {
+    const value_span Ct_i = scenarios.times(i), C_i = scenarios.concentrations(i);
+    const value_span Ct_j = scenarios.times(j), C_j = scenarios.concentrations(j);
+    const std::size_t n = std::min(Ct_i.size(), Ct_j.size());
+    std::size_t k = 0;
+    while (k < n && Ct_i[k] == Ct_j[k] && C_i[k] == C_j[k]) ++k;
+    return k;
+  }
+  /// lexicographic comparison of the measurements (Ct, C) of scenarios i and j
+  static int compare(const exposure_profiles& scenarios, const std::size_t i, const std::size_t j) {
+    const std::size_t k = common_prefix(scenarios, i, j);
+    const value_span Ct_i = scenarios.times(i), Ct_j = scenarios.times(j);
+    if (k == Ct_i.size() || k == Ct_j.size()) {
+      return Ct_i.size() < Ct_j.size() ? -1 : (Ct_i.size() > Ct_j.size() ? 1 : 0);
+    }
+    if (Ct_i[k] != Ct_j[k]) return Ct_i[k] < Ct_j[k] ? -1 : 1;
+    return scenarios.concentrations(i)[k] < scenarios.concentrations(j)[k] ? -1 : 1;
+  }
+  tProjector proj;
+  tData data;
+  std::vector<std::size_t > order;
+  std::vector<std::size_t > lcp;
+  std::size_t num_intervals;
+};
+
+#endif //GUTS_RED_PROFILES_H
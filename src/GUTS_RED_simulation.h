@@ -0,0 +1,373 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef GUTS_RED_SIMULATION_H
+#define GUTS_RED_SIMULATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "GUTS_RED.h"
+#include "external_data.h"
+
+/**
+ * Individual-based simulation of survivors, e.g. for posterior-predictive checks and
+ * virtual experiments. Each individual draws its threshold (from the threshold
+ * distribution of IT and Proper models, or the fixed threshold of SD and Proper-delta
+ * models) and an exponentially distributed hazard it can bear; it dies in the first
+ * survival interval in which its cumulative hazard exceeds the latter or, for IT, in which
+ * the maximum damage exceeds its threshold. The expected survival of the individuals
+ * equals the projection with the same time discretization and threshold distribution
+ * (for external samples of Proper models including the threshold at infinity, see
+ * sample_threshold).
+ */
+
+/**
+ * \brief pseudo-random numbers of one simulation stream (xoshiro256**)
+ * \details A stream is identified by a seed and a stream number (e.g. of a replicate); its
+ * state is derived from both with splitmix64. The numbers of a stream do not depend on the
+ * thread that draws them, i.e. simulations are reproducible for any number of threads.
+ * Variates are calculated here and not with the distributions of <random>, whose
+ * algorithms differ between standard libraries.
+ */
+class guts_rng {
+public:
+  guts_rng(const std::uint64_t seed, const std::uint64_t stream) {
+    std::uint64_t x = mix(seed) ^ mix(stream + 0x632BE59BD9B4E019ull);
+    for (std::uint64_t& v : st) {
+      x += 0x9E3779B97F4A7C15ull;
+      v = mix(x);
+    }
+  }
+  inline std::uint64_t next() {
+    const std::uint64_t result = rotl(st[1] * 5, 7) * 9;
+    const std::uint64_t t = st[1] << 17;
+    st[2] ^= st[0];
+    st[3] ^= st[1];
+    st[1] ^= st[2];
+    st[0] ^= st[3];
+    st[2] ^= t;
+    st[3] = rotl(st[3], 45);
+    return result;
+  }
+  /// uniform in (0, 1)
+  inline double uniform() {return (static_cast<double >(next() >> 11) + 0.5) / 9007199254740992.0;}
+  /// standard exponential
+  inline double exponential() {return -std::log(uniform());}
+  /// standard normal (Box-Muller)
+  inline double normal() {
+    const double r = std::sqrt(-2.0 * std::log(uniform()));
+    return r * std::cos(6.283185307179586 * uniform());
+  }
+private:
+  static inline std::uint64_t rotl(const std::uint64_t x, const int k) {return (x << k) | (x >> (64 - k));}
+  static inline std::uint64_t mix(std::uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  std::uint64_t st[4];
+};
+
+/// threshold of SD and Proper-delta models, equal for all individuals
+struct fixed_threshold {
+  explicit fixed_threshold(const double new_z) : z(new_z) {}
+  inline double operator()(guts_rng&) const {return z;}
+  double z;
+};
+
+/// lognormal thresholds with mean mn and standard deviation sd (as lognormal::CDF())
+struct lognormal_threshold {
+  lognormal_threshold(const double mn, const double sd) :
+    sigma(std::sqrt(std::log((sd * sd) / mn / mn + 1))),
+    mu(std::log(mn) - sigma * sigma / 2) {}
+  inline double operator()(guts_rng& rng) const {return std::exp(mu + sigma * rng.normal());}
+  double sigma;
+  double mu;
+};
+
+/// loglogistic thresholds with median alpha and shape beta (as loglogistic::CDF())
+struct loglogistic_threshold {
+  loglogistic_threshold(const double new_alpha, const double new_beta) : alpha(new_alpha), beta(new_beta) {}
+  inline double operator()(guts_rng& rng) const {
+    const double u = rng.uniform();
+    return alpha * std::pow(u / (1 - u), 1 / beta);
+  }
+  double alpha;
+  double beta;
+};
+
+/**
+ * \brief thresholds drawn from a sorted sample, optionally with probability weights
+ * \details W holds the sums of weights at and above each variate (see random_sample); empty for equal weights.
+ * Proper models add a threshold at infinity with weight 1/n of the raw sample of size n (see
+ * TD<random_sample, 'P'>), which is drawn with probability infinite_weight / (1 + infinite_weight).
+ */
+struct sample_threshold {
+  template<typename tz >
+  sample_threshold(const tz& variates, const tz& upper_weights, const double new_infinite_weight = 0) :
+    z(variates.begin(), variates.end()), W(upper_weights.begin(), upper_weights.end()), infinite_weight(new_infinite_weight) {}
+  inline double operator()(guts_rng& rng) const {
+    const double u = rng.uniform() * (1 + infinite_weight);
+    if (u >= 1) return std::numeric_limits<double >::infinity();
+    if (W.empty()) return z[std::min(static_cast<std::size_t >(u * static_cast<double >(z.size())), z.size() - 1)];
+    // last variate with a weight at and above it of at least 1 - u
+    const std::size_t i = std::upper_bound(W.begin(), W.end(), 1 - u, std::greater<double >()) - W.begin();
+    return z[i > 0 ? i - 1 : 0];
+  }
+  std::vector<double > z;
+  std::vector<double > W;
+  ///weight of the threshold at infinity, relative to the sample
+  double infinite_weight;
+};
+
+/**
+ * \brief survival interval i (from 1) of each grid point $j \cdot dtau$ with j < J before the last survival time
+ * \details Grid points are assigned as in guts_projector::gather_effect_per_time_step().
+ */
+template<typename tt >
+void grid_intervals(const std::size_t J, const double dtau, const tt& yt, std::vector<std::size_t >& interval) {
+  interval.resize(0);
+  std::size_t j = 0;
+  for (std::size_t i = 1; i < yt.size(); ++i) {
+    for (double tau = dtau * static_cast<double >(j); j < J && tau < yt[i]; tau = dtau * static_cast<double >(++j)) {
+      interval.push_back(i);
+    }
+  }
+}
+
+/**
+ * \brief damage D of the data at the times Dt (ascending), including all damage maxima
+ * \details Damage does not depend on TD; guts_projector_fastIT with thresholds at infinity
+ * projects all damage maxima.
+ */
+template<typename tt, typename tc, bool add_time_discretization, bool add_distribution_sample_size >
+void damage_maxima(const external_data<tt, tc, add_time_discretization, add_distribution_sample_size >& data,
+    const double kd, std::vector<double >& D, std::vector<double >& Dt) {
+  typedef std::vector<double > tv;
+  guts_projector_fastIT<guts_RED<tt, tc, TD_IT_loglogistic, tv >, tt, tv > proj;
+  proj.initialize(data);
+  typename guts_projector_fastIT<guts_RED<tt, tc, TD_IT_loglogistic, tv >, tt, tv >::state s;
+  project(proj, tv({0, kd, std::numeric_limits<double >::quiet_NaN(), std::numeric_limits<double >::infinity(), 1}), s);
+  D = s.damage;
+  Dt = s.damage_time;
+}
+
+/**
+ * \brief mortality of individuals with a damage-dependent hazard (SD and Proper)
+ * \details The hazard of an individual with threshold z at grid point j is
+ * $kk \max(D_j - z, 0) + hb$, summed over the time grid as in TD<double, 'S'> and
+ * TD_proper_base. Damages of each survival interval are sorted with suffix sums, so that
+ * the damage above a threshold is found by bisection.
+ */
+class hazard_mortality {
+public:
+  hazard_mortality() : kkXdtau(0), hb(0), yt(), Ds(), Ss(), offsets() {}
+  /**
+   * \brief projects the damage of the data on the time grid and sets the parameters
+   */
+  template<typename tt, typename tc, bool add_distribution_sample_size >
+  void initialize(
+      const external_data<tt, tc, true, add_distribution_sample_size >& data,
+      const double kd, const double kk, const double new_hb) {
+    typedef std::vector<double > tv;
+    // damage does not depend on TD; without mortality, the whole time grid is projected
+    guts_projector<guts_RED<tt, tc, TD_SD, tv >, tt, tv > proj;
+    proj.initialize(data);
+    typename guts_projector<guts_RED<tt, tc, TD_SD, tv >, tt, tv >::state s;
+    project(proj, tv({0, kd, 0, 0}), s);
+    initialize(s.D, data.calculate_dtau(), *data.yt, kk, new_hb);
+  }
+  /**
+   * \param[in] D damage at the grid points $j \cdot dtau$
+   * \param[in] dtau step width of the time grid
+   * \param[in] new_yt survival times
+   */
+  template<typename tDamage, typename tt >
+  void initialize(const tDamage& D, const double dtau, const tt& new_yt, const double kk, const double new_hb) {
+    kkXdtau = kk * dtau;
+    hb = new_hb;
+    yt.assign(new_yt.begin(), new_yt.end());
+    std::vector<std::size_t > interval;
+    grid_intervals(D.size(), dtau, yt, interval);
+    Ds.assign(D.begin(), D.begin() + interval.size());
+    offsets.assign(yt.size(), 0);
+    for (const std::size_t i : interval) ++offsets[i];
+    for (std::size_t i = 1; i < offsets.size(); ++i) {
+      offsets[i] += offsets[i-1];
+      std::sort(Ds.begin() + offsets[i-1], Ds.begin() + offsets[i]);
+    }
+    Ss.assign(Ds.size(), 0.0);
+    for (std::size_t i = 1; i < offsets.size(); ++i) {
+      double S = 0;
+      for (std::size_t l = offsets[i]; l > offsets[i-1]; --l) {
+        S += Ds[l-1];
+        Ss[l-1] = S;
+      }
+    }
+  }
+  inline std::size_t size() const {return yt.size();}
+  /// sum over the grid points of survival interval i (from 1) of the damage above z
+  inline double damage_excess(const std::size_t i, const double z) const {
+    const std::size_t end = offsets[i];
+    const std::size_t l = std::upper_bound(Ds.begin() + offsets[i-1], Ds.begin() + end, z) - Ds.begin();
+    return l < end ? Ss[l] - z * static_cast<double >(end - l) : 0.0;
+  }
+  /// cumulative hazards at the survival times of an individual with threshold z
+  void cumulative_hazards(const double z, std::vector<double >& H) const {
+    H.assign(yt.size(), 0.0);
+    double E = 0;
+    for (std::size_t i = 1; i < yt.size(); ++i) {
+      E += damage_excess(i, z);
+      H[i] = kkXdtau * E + hb * yt[i];
+    }
+  }
+  /// index of the first survival time at which an individual with threshold z and bearable hazard E is dead, or size()
+  inline std::size_t death_index(const double z, const double E) const {
+    double excess = 0;
+    for (std::size_t i = 1; i < yt.size(); ++i) {
+      excess += damage_excess(i, z);
+      if (kkXdtau * excess + hb * yt[i] > E) return i;
+    }
+    return yt.size();
+  }
+private:
+  double kkXdtau;
+  double hb;
+  std::vector<double > yt;
+  ///sorted damages of the grid points, per survival interval
+  std::vector<double > Ds;
+  ///suffix sums of Ds within each survival interval
+  std::vector<double > Ss;
+  ///survival interval i covers Ds[offsets[i-1]] to Ds[offsets[i]-1]
+  std::vector<std::size_t > offsets;
+};
+
+/**
+ * \brief mortality of individuals with individual tolerance (IT)
+ * \details An individual dies as soon as the maximum damage exceeds its threshold, as in
+ * TD<sampler, 'I'>, or from background mortality hb.
+ */
+class tolerance_mortality {
+public:
+  tolerance_mortality() : Dmax(), Hb() {}
+  /**
+   * \brief projects the maximum damage of the data at the survival times and sets hb
+   */
+  template<typename tt, typename tc, bool add_time_discretization, bool add_distribution_sample_size >
+  void initialize(
+      const external_data<tt, tc, add_time_discretization, add_distribution_sample_size >& data,
+      const double kd, const double hb) {
+    std::vector<double > D, Dt;
+    damage_maxima(data, kd, D, Dt);
+    initialize(D, Dt, *data.yt, hb);
+  }
+  /**
+   * \param[in] D damage at the times Dt (ascending), including damage maxima
+   * \param[in] yt survival times
+   */
+  template<typename tDamage, typename tt >
+  void initialize(const tDamage& D, const tDamage& Dt, const tt& yt, const double hb) {
+    Dmax.assign(yt.size(), 0.0);
+    Hb.assign(yt.size(), 0.0);
+    double M = 0;
+    std::size_t l = 0;
+    for (std::size_t i = 0; i < yt.size(); ++i) {
+      for (; l < D.size() && Dt[l] <= yt[i]; ++l) M = std::max(M, D[l]);
+      Dmax[i] = M;
+      Hb[i] = hb * yt[i];
+    }
+  }
+  inline std::size_t size() const {return Dmax.size();}
+  inline std::size_t death_index(const double z, const double E) const {
+    return std::min(
+      std::upper_bound(Dmax.begin(), Dmax.end(), z) - Dmax.begin(),
+      std::upper_bound(Hb.begin(), Hb.end(), E) - Hb.begin()
+    );
+  }
+private:
+  ///maximum damage until each survival time
+  std::vector<double > Dmax;
+  ///cumulative background hazard at each survival time
+  std::vector<double > Hb;
+};
+
+/**
+ * \brief simulates the survivors of n individuals
+ * \param[out] y survivors at the survival times
+ */
+template<typename tMortality, typename tThreshold >
+void simulate_survivors(const tMortality& mortality, const tThreshold& threshold, const std::size_t n,
+    guts_rng& rng, std::vector<std::size_t >& y) {
+  y.assign(mortality.size() + 1, 0);
+  for (std::size_t m = 0; m < n; ++m) {
+    const double z = threshold(rng);
+    ++y[mortality.death_index(z, rng.exponential())];
+  }
+  // deaths per survival time to survivors
+  std::size_t alive = n;
+  for (std::size_t i = 0; i < mortality.size(); ++i) {
+    alive -= y[i];
+    y[i] = alive;
+  }
+  y.pop_back();
+}
+
+/**
+ * \brief simulates the survivors of n individuals with a fixed threshold
+ * \details Cumulative hazards are equal for all individuals and calculated once.
+ */
+inline void simulate_survivors(const hazard_mortality& mortality, const fixed_threshold& threshold, const std::size_t n,
+    guts_rng& rng, std::vector<std::size_t >& y) {
+  std::vector<double > H;
+  mortality.cumulative_hazards(threshold.z, H);
+  y.assign(H.size() + 1, 0);
+  for (std::size_t m = 0; m < n; ++m) {
+    ++y[std::upper_bound(H.begin(), H.end(), rng.exponential()) - H.begin()];
+  }
+  std::size_t alive = n;
+  for (std::size_t i = 0; i < H.size(); ++i) {
+    alive -= y[i];
+    y[i] = alive;
+  }
+  y.pop_back();
+}
+
+/**
+ * \brief simulates replicates of n individuals each, in parallel
+ * \details Replicate r uses stream first_stream + r of the seed, independent of the number of threads.
+ * \param[out] y survivors, column-major with nrow rows, of which replicate r fills row row0 + r
+ */
+template<typename tMortality, typename tThreshold, typename tCount >
+void simulate_replicates(const tMortality& mortality, const tThreshold& threshold,
+    const std::size_t n, const std::size_t replicates,
+    const std::uint64_t seed, const std::uint64_t first_stream, const std::size_t num_threads,
+    tCount* y, const std::size_t nrow, const std::size_t row0) {
+  const std::size_t T = mortality.size();
+#ifdef _OPENMP
+  #pragma omp parallel num_threads(static_cast<int >(std::max<std::size_t >(1, std::min(num_threads, replicates))))
+#endif
+  {
+    std::vector<std::size_t > survivors;
+#ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (long r = 0; r < static_cast<long >(replicates); ++r) {
+      guts_rng rng(seed, first_stream + static_cast<std::uint64_t >(r));
+      simulate_survivors(mortality, threshold, n, rng, survivors);
+      for (std::size_t i = 0; i < T; ++i) y[row0 + r + i * nrow] = static_cast<tCount >(survivors[i]);
+    }
+  }
+}
+
+#endif //GUTS_RED_SIMULATION_H
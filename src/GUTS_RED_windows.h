@@ -0,0 +1,168 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef GUTS_RED_WINDOWS_H
+#define GUTS_RED_WINDOWS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "helpers.h"
+#include "exposure_profiles.h"
+#include "GUTS_RED_profiles.h"
+
+/**
+ * \brief buffers of the exposure profiles of a block of windows
+ */
+struct window_block {
+  std::vector<double > Ct;
+  std::vector<double > C;
+  std::vector<std::uint64_t > offsets;
+};
+
+/**
+ * \brief time windows of fixed length moving over a long exposure profile
+ * \details The time grid of a window has M steps. Window i starts at grid step
+ * i * steps_per_shift of the whole profile, as long as it ends within the profile.
+ * Each window is an exposure profile of its own, with times relative to its start:
+ * the start, the concentration measurement times within the window and the end.
+ * Concentrations at the start and the end are interpolated linearly, unless they
+ * are measurement times. Windows are built in blocks, such that memory does not
+ * grow with the number of windows.
+ */
+class exposure_windows {
+public:
+  /**
+   * \param[in] Ct concentration measurement times of the whole profile, starting at 0
+   * \param[in] C concentrations of the whole profile
+   * \param[in] window length of the windows
+   * \param[in] M number of grid steps per window
+   * \param[in] steps_per_shift number of grid steps between the starts of consecutive windows
+   * \throws std::invalid_argument if the profile is shorter than one window
+   */
+  exposure_windows(const std::vector<double >& Ct, const std::vector<double >& C, const double window,
+      const std::size_t M, const std::size_t steps_per_shift) :
+    Ct(Ct), C(C), window(window), m(std::max<std::size_t >(M, 1)), shift(std::max<std::size_t >(steps_per_shift, 1)) {
+    const double dtau = window / static_cast<double >(m);
+    const std::size_t steps = static_cast<std::size_t >(std::floor(back(Ct) / dtau * (1.0 + 1e-12)));
+    if (steps < m) {
+      throw std::invalid_argument("The exposure profile must not be shorter than one window.");
+    }
+    num_windows = (steps - m) / shift + 1;
+  }
+  /// number of windows
+  inline std::size_t size() const {return num_windows;}
+  /// start time of window i
+  inline double start(const std::size_t i) const {
+    return window * static_cast<double >(i * shift) / static_cast<double >(m);
+  }
+  /**
+   * \brief windows first, ..., end - 1 as exposure profiles
+   * \param[out] block buffers of the profiles, to which the returned profiles refer
+   */
+  exposure_profiles profiles(const std::size_t first, const std::size_t end, window_block& block) const {
+    block.Ct.clear();
+    block.C.clear();
+    block.offsets.assign(1, 0);
+    for (std::size_t i = first; i < end; ++i) {
+      const double t0 = start(i);
+      const double t1 = t0 + window;
+      std::size_t k = std::upper_bound(Ct.begin(), Ct.end(), t0) - Ct.begin() - 1;
+      block.Ct.push_back(0.0);
+      block.C.push_back(interpolate(k, t0));
+      for (++k; k < Ct.size() && Ct[k] < t1 && Ct[k] - t0 < window; ++k) {
+        block.Ct.push_back(Ct[k] - t0);
+        block.C.push_back(C[k]);
+      }
+      block.Ct.push_back(window);
+      block.C.push_back(interpolate(std::min(k, Ct.size()) - 1, t1));
+      block.offsets.push_back(block.Ct.size());
+    }
+    return exposure_profiles(block.Ct.data(), block.C.data(), block.offsets.data(), end - first);
+  }
+protected:
+  /// concentration at time t within interval k (Ct[k] <= t <= Ct[k+1]); constant after the last measurement
+  double interpolate(const std::size_t k, const double t) const {
+    if (t == Ct[k] || k + 1 == Ct.size()) return C[k];
+    if (t == Ct[k+1]) return C[k+1];
+    return C[k] + (C[k+1] - C[k]) * (t - Ct[k]) / (Ct[k+1] - Ct[k]);
+  }
+  const std::vector<double >& Ct;
+  const std::vector<double >& C;
+  double window;
+  ///grid steps per window
+  std::size_t m;
+  ///grid steps between window starts
+  std::size_t shift;
+  std::size_t num_windows;
+};
+
+/**
+ * \brief projects survival for time windows of fixed length moving over a long exposure profile
+ * \details Each window starts with zero damage and is projected as a separate exposure
+ * profile with guts_profile_projector, i.e. with the projector of a separate projection
+ * (closed-form solutions for constant exposure). Survival and LPx of a window thus
+ * equal those of its profile in guts_calc_profiles. Windows are projected in blocks;
+ * the profiles of a block are projected in parallel.
+ *
+ * \tparam tProjector projector type on value_span data
+ * \tparam tData data type of the projector with value_span times and concentrations
+ */
+template<typename tProjector, typename tData >
+class guts_window_projector {
+public:
+  guts_window_projector() : block_size(4096), num_times(0) {}
+  virtual ~guts_window_projector() {}
+  inline void set_num_threads(const std::size_t new_num_threads) {proj.set_num_threads(new_num_threads);}
+  inline void set_LPx_tolerance(const double rel_tol) {proj.set_LPx_tolerance(rel_tol);}
+  /**
+   * \brief creates the projectors of the profiles
+   * \param[in] data survival times {0, window length}, grid steps per window M and SVR,
+   * with the exposure of a window (e.g. the first one)
+   * \param[in] parameters model parameters
+   * \param[in] setup called with each projector before parameterization (e.g. to set an external threshold sample)
+   */
+  template<typename tParameters, typename tSetup >
+  void initialize(const tData& data, const tParameters& parameters, const tSetup& setup) {
+    proj.initialize(data, parameters, setup);
+    num_times = data.yt->size();
+  }
+  /**
+   * \brief projects all windows
+   * \param[in] windows windows of the exposure profile
+   * \param[in] x effect levels in percent for LPx (may be empty)
+   * \param[out] S survival at the end of each window (windows.size() values)
+   * \param[out] LPx multiplication factors, column-major with one row per window (windows.size() * x.size() values)
+   */
+  void project(const exposure_windows& windows, const std::vector<double >& x, double* S, double* LPx) {
+    const std::size_t W = windows.size();
+    window_block block;
+    std::vector<double > S_block, LPx_block;
+    for (std::size_t first = 0; first < W; first += block_size) {
+      const std::size_t n = std::min(W - first, block_size);
+      S_block.assign(n * num_times, 0.0);
+      LPx_block.assign(n * x.size(), 0.0);
+      proj.project(windows.profiles(first, first + n, block), x, S_block.data(), LPx_block.data());
+      for (std::size_t i = 0; i < n; ++i) {
+        S[first + i] = S_block[i + (num_times - 1) * n];
+        for (std::size_t l = 0; l < x.size(); ++l) LPx[first + i + l * W] = LPx_block[i + l * n];
+      }
+    }
+  }
+protected:
+  guts_profile_projector<tProjector, tData > proj;
+  ///number of windows per block
+  std::size_t block_size;
+  ///number of survival times
+  std::size_t num_times;
+};
+
+#endif //GUTS_RED_WINDOWS_H
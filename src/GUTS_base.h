@@ -18,20 +18,33 @@
 #include <limits>
 #include <algorithm>
 #include <functional>
+#include <stdexcept>
 
 
 #include "helpers.h"
+#include "TK_base.h"
+#include "TD_base.h"
 
 /** 
  * \brief Defines the public combination of a TK and a TD object 
  * \tparam TK Type of TK model
  * \tparam TD Type of TD model
  * \tparam tData object with model relevant data
- * \detail This generic definition should be parent of any guts_model
+ * \detail This generic definition should be parent of any guts_model.
+ * The model holds data and parameters. All quantities that change during a 
+ * projection are kept in a state object, i.e. a parameterized model can be 
+ * projected by several threads concurrently, each with its own state.
  */
 template<typename TK_mod, typename TD_mod >
 struct guts_model: 
   virtual public TK_mod, virtual public TD_mod {
+  /**
+   * \brief mutable state of TK and TD during one projection
+   */
+  struct state {
+    TK_state TK;
+    typename TD_mod::state TD;
+  };
   virtual ~guts_model() {};
   template<typename tData >
   inline void initialize(const tData& data) {
@@ -42,9 +55,9 @@ struct guts_model:
   	TK_mod::initialize_from_parameters();
   	TD_mod::initialize_from_parameters();
   	}
-  void set_start_conditions() const override {
-    TK_mod::set_start_conditions();
-    TD_mod::set_start_conditions();
+  void set_start_conditions(state& s) const {
+    TK_mod::set_start_conditions(s.TK);
+    TD_mod::set_start_conditions(s.TD);
   }
   guts_model() : TK_mod(), TD_mod() {}
 };
@@ -52,42 +65,132 @@ struct guts_model:
 template<typename tModel, typename tt, typename tSurvival >
 struct guts_projector_base : public tModel {
   typedef tSurvival tProjection;
+  /**
+   * \brief state of one projection
+   * \details States are values: a copy is a checkpoint of the projection, from 
+   * which the projection can be continued (see continue_projection()) as often 
+   * as needed, e.g. with exposures that differ only after the checkpoint.
+   */
+  struct state : public tModel::state {
+    state() : p(), p0(1), ytpos(0) {}
+    ///survival probabilities at survival measurement times
+    tSurvival p;
+    ///survival at time 0 (before normalization)
+    double p0;
+    ///index of the next survival measurement time to project
+    std::size_t ytpos;
+  };
   virtual ~guts_projector_base() {}
-  inline void set_start_conditions() const override {
-  	tModel::set_start_conditions();
+  inline void set_start_conditions(state& s) const {
+  	tModel::set_start_conditions(s);
   }
-  inline void get_survival_projection(tProjection& proj) const {proj = p;}
-  void project_survival () const {
-    p.assign(yt->size(), 0);
-    
-    p.at(0) = tModel::TD_mod::calculate_current_survival(0);
-    if ( p.at(0) <= 0.0 ) {
+  inline void get_survival_projection(const state& s, tProjection& proj) const {proj = s.p;}
+  virtual void project_survival (state& s) const {
+    start_projection(s);
+    continue_projection(s, yt->size());
+  }
+  /**
+   * \brief initializes survival at time 0; the state must be at its start conditions
+   */
+  void start_projection(state& s) const {
+    s.p.assign(yt->size(), 0);
+    s.p0 = tModel::TD_mod::calculate_current_survival(s.TD, 0);
+    if ( s.p0 <= 0.0 ) {
       // should never happen with well defined parameters
       throw std::underflow_error("Numeric underflow: Survival cannot be calculated for given parameter values." );
     }
-    auto ytpos = 1; //index yt
-    while (ytpos < yt->size() && p.at(ytpos-1) > 0) {
-      tModel::TD_mod::update_to_next_survival_measurement();
-      gather_effect_per_time_step(yt->at(ytpos), yt->at(ytpos-1));
-      p.at(ytpos) = tModel::TD_mod::calculate_current_survival(yt->at(ytpos)) / p.at(0);
+    s.p.at(0) = 1;
+    s.ytpos = 1;
+  }
+  /**
+   * \brief projects survival up to (excluding) survival measurement index ytpos_end
+   * \details Continues from the survival measurement time of the state. Exposure 
+   * must not have changed up to this time (more precisely, up to the end of the 
+   * concentration interval containing it).
+   */
+  void continue_projection(state& s, const std::size_t ytpos_end) const {
+    tSurvival& p = s.p;
+    std::size_t& ytpos = s.ytpos;
+    while (ytpos < ytpos_end && ytpos < yt->size() && p.at(ytpos-1) > 0) {
+      tModel::TD_mod::update_to_next_survival_measurement(s.TD);
+      gather_effect_per_time_step(s, yt->at(ytpos), yt->at(ytpos-1));
+      p.at(ytpos) = tModel::TD_mod::calculate_current_survival(s.TD, yt->at(ytpos)) / s.p0;
       ++ytpos;
     }
-    p.at(0) = 1;
   }
-  virtual std::vector<double > get_damage() const = 0;
-  virtual std::vector<double > get_damage_time() const = 0;
+  /**
+   * \brief projects survival and accumulates the log-likelihood of survivors y on the fly
+   * \details Equals calculate_loglikelihood() of the projection, but survival is not
+   * stored (s.p is not updated). All terms of the log-likelihood are at most 0, i.e. the
+   * partial sum is an upper bound of the final value. The projection stops as soon as
+   * the partial sum falls below LL_min (e.g. the acceptance threshold of a Metropolis
+   * step); the partial sum is returned then. The state must be at its start conditions.
+   * \param[in] y numbers of survivors at the survival times
+   * \param[in] LL_min lower bound of interest
+   * \returns the log-likelihood, or a value below LL_min that is at least the log-likelihood
+   */
+  template<typename tmeasured_survivors >
+  double project_loglikelihood(state& s, const tmeasured_survivors& y,
+      const double LL_min = -std::numeric_limits<double >::infinity()) const {
+    GUTS_PHASE(projection);
+    const std::size_t n = yt->size();
+    s.p0 = tModel::TD_mod::calculate_current_survival(s.TD, 0);
+    if ( s.p0 <= 0.0 ) {
+      // should never happen with well defined parameters
+      throw std::underflow_error("Numeric underflow: Survival cannot be calculated for given parameter values." );
+    }
+    double loglik = 0;
+    double p_previous = 1;
+    double p = 1;
+    for (s.ytpos = 1; s.ytpos < n; ++s.ytpos) {
+      if (p_previous > 0) {
+        tModel::TD_mod::update_to_next_survival_measurement(s.TD);
+        gather_effect_per_time_step(s, yt->at(s.ytpos), yt->at(s.ytpos-1));
+        p = tModel::TD_mod::calculate_current_survival(s.TD, yt->at(s.ytpos)) / s.p0;
+      } else {
+        p = 0;
+      }
+      const double diffy = static_cast<double >(y[s.ytpos-1]) - static_cast<double >(y[s.ytpos]);
+      if (diffy > 0) {
+        const double diffS = p_previous - p;
+        if (diffS == 0.0) return -std::numeric_limits<double >::infinity();
+        GUTS_COUNT(exp_log_calls);
+        loglik += diffy * std::log(diffS);
+        if (loglik < LL_min) return loglik;
+      }
+      p_previous = p;
+    }
+    const double y_end = static_cast<double >(y[n-1]);
+    if (y_end > 0) {
+      if (p == 0.0) return -std::numeric_limits<double >::infinity();
+      GUTS_COUNT(exp_log_calls);
+      loglik += y_end * std::log(p);
+    }
+    return loglik;
+  }
+  /**
+   * \brief updates the model after values were appended to the data it was initialized with
+   * \details Appended exposure must start after the last concentration measurement 
+   * time, appended survival times after the last survival time.
+   */
+  inline void extend_data() {
+    tModel::TK_mod::extend_exposure();
+  }
+  /**
+   * \brief prepares a state for continuation after data were appended (see extend_data())
+   */
+  inline void extend_projection(state& s) const {
+    s.p.resize(yt->size(), 0);
+  }
   template<typename tData >
   inline void initialize(const tData& data) {
     yt = data.yt;
-    p.assign(yt->size(), std::numeric_limits<double>::quiet_NaN());
     tModel::initialize(data);
   }
   //tData exp_dat;
 protected:
   std::shared_ptr<const tt > yt;
-  virtual void gather_effect_per_time_step(const double, const double) const = 0;
-private:
-  mutable tSurvival p;
+  virtual void gather_effect_per_time_step(state& s, const double, const double) const = 0;
 };
 
 template<typename tModel, typename tt, typename tSurvival >
@@ -95,6 +198,16 @@ struct guts_projector: public guts_projector_base<tModel, tt, tSurvival > {
 public:
 	typedef tSurvival tProjection;
 	typedef guts_projector_base<tModel, tt, tSurvival > parent;
+	/**
+	 * \brief state of one projection on the time grid
+	 */
+	struct state : public parent::state {
+		state() : D(), tauit(0), k(0) {}
+		///damage at discrete time steps
+		std::vector<double > D;
+		std::size_t tauit; //index discrete time
+		std::size_t k;     //index Ct
+	};
 	virtual ~guts_projector() {}
 	template<typename tData >
 	inline void initialize(const tData& data) {
@@ -102,19 +215,33 @@ public:
 	  dtau = data.calculate_dtau(); 
 	  parent::initialize(data);
 	}
-	inline void set_start_conditions() const override {
-		tauit = 0; //index discrete time
-		k = 0;     //index Ct
-		D.assign(M, std::numeric_limits<double>::quiet_NaN());
-		parent::set_start_conditions();
+	inline void set_start_conditions(state& s) const {
+		s.tauit = 0; //index discrete time
+		s.k = 0;     //index Ct
+		s.D.assign(M, std::numeric_limits<double>::quiet_NaN());
+		parent::set_start_conditions(s);
+	}
+	/**
+	 * \brief updates the model after data were appended
+	 * \details The step width dtau is kept and the time grid is extended to the last 
+	 * survival time, i.e. the projection equals a projection of all data on a grid
+	 * with the same step width.
+	 */
+	inline void extend_data() {
+		M = std::max(M, static_cast<std::size_t >(std::ceil(back(*this->yt) / dtau)));
+		parent::extend_data();
 	}
-	std::vector<double > get_damage() const override {return D;}
-	std::vector<double > get_damage_time() const override {
+	inline void extend_projection(state& s) const {
+		s.D.resize(M, std::numeric_limits<double>::quiet_NaN());
+		parent::extend_projection(s);
+	}
+	std::vector<double > get_damage(const state& s) const {return s.D;}
+	std::vector<double > get_damage_time(const state& s) const {
 		std::vector<double > damage_time(M, std::numeric_limits<double>::quiet_NaN());
 		damage_time[0] = 0;
 		for (
 				std::vector<double >::iterator it = damage_time.begin() + 1; 
-      it != damage_time.begin() + tauit;
+      it != damage_time.begin() + s.tauit;
       ++it) { 
        *it = *(it-1) + dtau;
 		}
@@ -123,23 +250,22 @@ public:
 protected:
 	std::size_t M;
 	double dtau;
-	mutable std::vector<double > D;
 private:
-	mutable std::size_t tauit; //index discrete time
-	mutable std::size_t k;     //index Ct
 	void gather_effect_per_time_step (
+			typename parent::state& ps,
 			const double yt, 
 			const double
 		) const override {
+		state& s = static_cast<state& >(ps);
+		std::size_t& tauit = s.tauit;
+		std::size_t& k = s.k;
 		double tau = dtau * static_cast<double>(tauit);		 //discrete absolute time
-		while ( tauit < M && tau < yt && tModel::TD_mod::is_still_gathering() ) {
-			D.at(tauit) = tModel::TK_mod::calculate_damage(k, tau);
-			tModel::TD_mod::gather_effect(D[tauit]);
-			tau = dtau * static_cast<double>(++tauit);
-			if (tau > tModel::TK_mod::Ct->at(k+1)) {
-				++k; // concentration index
-				tModel::TK_mod::update_to_next_concentration_measurement();
-			}
+		while ( tauit < M && tau < yt && tModel::TD_mod::is_still_gathering(s.TD) ) {
+			const double tau_next = dtau * static_cast<double>(tauit + 1);
+			s.D.at(tauit) = tModel::TK_mod::calculate_grid_damage(s.TK, k, tau, tau_next);
+			tModel::TD_mod::gather_effect(s.TD, s.D[tauit]);
+			tau = tau_next;
+			++tauit;
 		}
 	}
 };
@@ -150,110 +276,293 @@ struct guts_projector_fastIT:
 public:
 	typedef tSurvival tProjection;
 	typedef guts_projector_base<tModel, tt, tSurvival > parent;
+	/**
+	 * \brief state of one projection at concentration boundaries and damage extrema
+	 */
+	struct state : public parent::state {
+		state() : k(0), Dk(0), damage_time(), damage() {}
+		std::size_t k;
+		std::size_t Dk;
+		std::vector<double > damage_time;
+		std::vector<double > damage;
+	};
 	virtual ~guts_projector_fastIT() {}
-	inline void set_start_conditions() const override {
-		k = 0;
-		Dk = 0;
-		damage.resize(0);
-		damage_time.resize(0);
-		damage_time.push_back(0);
-		damage.push_back(0);
-		parent::set_start_conditions();
+	inline void set_start_conditions(state& s) const {
+		s.k = 0;
+		s.Dk = 0;
+		s.damage.resize(0);
+		s.damage_time.resize(0);
+		s.damage_time.push_back(0);
+		s.damage.push_back(0);
+		parent::set_start_conditions(s);
 	}
-	std::vector<double > get_damage() const override {
+	std::vector<double > get_damage(state& s) const {
 		// ensure that the function is not called repeatedly. 
 		// Note: survival calculations automatically increase Dk.
-		if (Dk != 0) {
-			tModel::TK_mod::set_start_conditions();
-			extend_damage_values();
+		if (s.Dk != 0) {
+			tModel::TK_mod::set_start_conditions(s.TK);
+			extend_damage_values(s);
 		}
-		return damage;
+		return s.damage;
 		}
-	std::vector<double > get_damage_time() const override {
+	std::vector<double > get_damage_time(state& s) const {
 		// ensure that the function is not called repeatedly. 
 		// Note: survival calculations automatically increase Dk.
-		if (Dk != 0) {
-			tModel::TK_mod::set_start_conditions();
-			extend_damage_values();
+		if (s.Dk != 0) {
+			tModel::TK_mod::set_start_conditions(s.TK);
+			extend_damage_values(s);
 		}
-		return damage_time;
+		return s.damage_time;
 	}
 	
 private:
-	mutable std::size_t k;
-	mutable std::size_t Dk;
-	mutable std::vector<double > damage_time;
-	mutable std::vector<double > damage;
 	void gather_effect_per_time_step (
+			typename parent::state& ps,
 			const double yt, 
 			const double yt_previous
 		) const override {
-		double te;
-		std::size_t Dk_old = Dk;
-		while (this->Ct->at(k+1) < yt && this->is_still_gathering() ) {
-			//Note: the while loop excludes potential theoretical maxima before the second
-			//  concentration measurement.
-			//  This is correct with the underlying assumption that
-			//  at the beginning of the experiment, damage is 0 and thus 
-			//  the maximum of damage during this first concentration interval 
-			//  automatically is at yt that are measured during the first concentation
-			//  interval.
-			//  From the second concentration measurement on, all damage extremes 
-			//  are considered.
-			
-			// check damage at theoretical global maximum
-			if (this->is_maximum_damage(k)) {
-				//theoretically a maximum exists somewhere in time (at an extreme point)
-				//calculate the timing of the global maximum
-				te = this->calculate_time_of_extreme_damage(k);
-				if (te > yt_previous && te < yt) {
-					// the maximum is within the current survival measurement interval
-					if (te > this->Ct->at(k) && te < this->Ct->at(k+1)) {
-						// the maximum is within the current concentration measurement interval
-						damage_time.push_back(te);
-						damage.push_back(this->calculate_damage(k, te));
-						++Dk;
-					}
-				}
-			}
+		state& s = static_cast<state& >(ps);
+		std::size_t& k = s.k;
+		std::vector<double >& damage_time = s.damage_time;
+		std::vector<double >& damage = s.damage;
+		std::size_t Dk_old = s.Dk;
+		while (this->Ct->at(k+1) < yt && this->is_still_gathering(s.TD) ) {
+			// check damage at a maximum within the concentration interval
+			add_damage_maximum(s, std::max(yt_previous, this->Ct->at(k)), this->Ct->at(k+1));
 		  // check damage at concentration measurement times (i.e. boundaries)
 		  	damage_time.push_back(this->Ct->at(k+1));
-		  	damage.push_back(this->calculate_damage(k, back(damage_time)));
-        ++Dk;
+		  	damage.push_back(this->calculate_damage(s.TK, k, back(damage_time)));
+        ++s.Dk;
         ++k;
-        this->update_to_next_concentration_measurement();
+        this->update_to_next_concentration_measurement(s.TK);
 		  }
+		// the maximum may also lie in the part of the concentration interval before yt
+		add_damage_maximum(s, std::max(yt_previous, this->Ct->at(k)), yt);
 		damage_time.push_back(yt);
-		damage.push_back(this->calculate_damage(k, yt));
-		++Dk;
-		this->gather_effect( 
+		damage.push_back(this->calculate_damage(s.TK, k, yt));
+		++s.Dk;
+		this->gather_effect(s.TD, 
 				*(std::max_element(damage.begin() + Dk_old, damage.end())) 
 			);
 	}
 	
-	void extend_damage_values(std::size_t num_extra_evals_per_time_interval = 10) const {
+	/**
+	 * \brief adds the damage maximum of the current concentration interval if it lies within (t_begin, t_end)
+	 */
+	void add_damage_maximum(state& s, const double t_begin, const double t_end) const {
+		if (this->is_maximum_damage(s.TK, s.k)) {
+			//theoretically a maximum exists somewhere in time (at an extreme point)
+			const double te = this->calculate_time_of_extreme_damage(s.TK, s.k);
+			if (te > t_begin && te < t_end) {
+				s.damage_time.push_back(te);
+				s.damage.push_back(this->calculate_damage(s.TK, s.k, te));
+				++s.Dk;
+			}
+		}
+	}
+	
+	void extend_damage_values(state& s, std::size_t num_extra_evals_per_time_interval = 10) const {
+		std::size_t& k = s.k;
 		double dtau;
-		double max_time = *(std::max_element(damage_time.begin(), damage_time.end()));
+		double max_time = *(std::max_element(s.damage_time.begin(), s.damage_time.end()));
 		double cur_time;
 		k = 0;
-		Dk = 0;
+		s.Dk = 0;
 		while (this->Ct->at(k) < max_time) {
 				dtau = (this->Ct->at(k+1) - this->Ct->at(k)) / static_cast<double>(num_extra_evals_per_time_interval);
 				cur_time = this->Ct->at(k) + dtau;
 				do {
-					damage_time.push_back(cur_time);
-					damage.push_back(this->calculate_damage(k, cur_time));
+					s.damage_time.push_back(cur_time);
+					s.damage.push_back(this->calculate_damage(s.TK, k, cur_time));
 					cur_time += dtau;
 				} while (cur_time < this->Ct->at(k+1) && cur_time < max_time);
-				this->calculate_damage(k, this->Ct->at(k+1));
+				this->calculate_damage(s.TK, k, this->Ct->at(k+1));
 				++k;
-				this->update_to_next_concentration_measurement();
+				this->update_to_next_concentration_measurement(s.TK);
+		}
+	}
+};
+
+/**
+ * \brief Projector that feeds one damage trajectory to several TD models
+ * \details Damage is calculated once per discrete time step and passed to all 
+ * registered TD consumers (e.g. SD, IT and Proper models with equal kd). 
+ * The consumers must be initialized with the same data, in particular with the 
+ * same time discretization, and be parameterized before projection. 
+ * Survival is projected separately for each consumer.
+ * \tparam TK_mod Type of TK model
+ */
+template<typename TK_mod, typename tt, typename tSurvival >
+struct guts_projector_fan_out: public TK_mod {
+public:
+	typedef tSurvival tProjection;
+	/**
+	 * \brief state of one projection, with one TD state per consumer
+	 */
+	struct state {
+		state() : TK(), TD(), tauit(0), k(0), D(), p() {}
+		TK_state TK;
+		std::vector<std::unique_ptr<TD_base::state > > TD;
+		std::size_t tauit; //index discrete time
+		std::size_t k;     //index Ct
+		std::vector<double > D;
+		std::vector<tSurvival > p;
+	};
+	virtual ~guts_projector_fan_out() {}
+	template<typename tData >
+	inline void initialize(const tData& data) {
+		M = data.M;
+		dtau = data.calculate_dtau();
+		yt = data.yt;
+		TK_mod::initialize(data);
+	}
+	/**
+	 * \brief register a TD model; the model is not owned by the projector
+	 */
+	inline void add_consumer(const TD_base& TD) {consumers.push_back(&TD);}
+	inline std::size_t num_consumers() const {return consumers.size();}
+	void set_start_conditions(state& s) const {
+		s.tauit = 0;
+		s.k = 0;
+		s.D.assign(M, std::numeric_limits<double>::quiet_NaN());
+		TK_mod::set_start_conditions(s.TK);
+		if (s.TD.size() != consumers.size()) {
+			s.TD.clear();
+			for (auto TD : consumers) s.TD.push_back(TD->make_state());
+		}
+		for (std::size_t i = 0; i < consumers.size(); ++i) consumers[i]->set_start_conditions(*s.TD[i]);
+	}
+	void project_survival(state& s) const {
+		std::vector<tSurvival >& p = s.p;
+		p.assign(consumers.size(), tSurvival(yt->size(), 0));
+		for (std::size_t i = 0; i < consumers.size(); ++i) {
+			p[i].at(0) = consumers[i]->calculate_current_survival(*s.TD[i], 0);
+			if ( p[i].at(0) <= 0.0 ) {
+				// should never happen with well defined parameters
+				throw std::underflow_error("Numeric underflow: Survival cannot be calculated for given parameter values." );
+			}
+		}
+		for (std::size_t ytpos = 1; ytpos < yt->size(); ++ytpos) {
+			for (std::size_t i = 0; i < consumers.size(); ++i) consumers[i]->update_to_next_survival_measurement(*s.TD[i]);
+			gather_effect_per_time_step(s, yt->at(ytpos));
+			for (std::size_t i = 0; i < consumers.size(); ++i) {
+				if (p[i].at(ytpos-1) > 0) {
+					p[i].at(ytpos) = consumers[i]->calculate_current_survival(*s.TD[i], yt->at(ytpos)) / p[i].at(0);
+				}
+			}
+		}
+		for (auto& pi : p) pi.at(0) = 1;
+	}
+	inline void get_survival_projection(const state& s, const std::size_t i, tProjection& proj) const {proj = s.p.at(i);}
+	std::vector<double > get_damage(const state& s) const {return s.D;}
+	std::vector<double > get_damage_time(const state& s) const {
+		std::vector<double > damage_time(M, std::numeric_limits<double>::quiet_NaN());
+		damage_time[0] = 0;
+		for (std::size_t i = 1; i < s.tauit; ++i) {
+			damage_time[i] = damage_time[i-1] + dtau;
+		}
+		return damage_time;
+	}
+protected:
+	std::size_t M;
+	double dtau;
+	std::shared_ptr<const tt > yt;
+	std::vector<const TD_base* > consumers;
+private:
+	bool is_still_gathering(const state& s) const {
+		for (std::size_t i = 0; i < consumers.size(); ++i) {
+			if (consumers[i]->is_still_gathering(*s.TD[i])) return true;
+		}
+		return false;
+	}
+	void gather_effect_per_time_step(state& s, const double yt) const {
+		std::size_t& tauit = s.tauit;
+		std::size_t& k = s.k;
+		double tau = dtau * static_cast<double>(tauit);		 //discrete absolute time
+		while ( tauit < M && tau < yt && is_still_gathering(s) ) {
+			const double tau_next = dtau * static_cast<double>(tauit + 1);
+			s.D.at(tauit) = TK_mod::calculate_grid_damage(s.TK, k, tau, tau_next);
+			for (std::size_t i = 0; i < consumers.size(); ++i) {
+				if (consumers[i]->is_still_gathering(*s.TD[i])) consumers[i]->gather_effect(*s.TD[i], s.D[tauit]);
+			}
+			tau = tau_next;
+			++tauit;
+		}
+	}
+};
+
+/**
+ * \brief Projector for constant exposure
+ * \details Damage and survival are evaluated with closed-form solutions at the 
+ * survival measurement times only. No time discretization is needed.
+ * Requires TK_mod::is_constant_exposure(); projections of other exposure throw std::invalid_argument.
+ */
+template<typename tModel, typename tt, typename tSurvival >
+struct guts_projector_constant_exposure: 
+  public guts_projector_base<tModel, tt, tSurvival > {
+public:
+	typedef tSurvival tProjection;
+	typedef guts_projector_base<tModel, tt, tSurvival > parent;
+	/**
+	 * \brief state of one projection with damage at survival measurement times
+	 */
+	struct state : public parent::state {
+		std::vector<double > damage;
+	};
+	virtual ~guts_projector_constant_exposure() {}
+	inline void set_start_conditions(state& s) const {
+		parent::set_start_conditions(s);
+	}
+	void project_survival (typename parent::state& ps) const override {
+		if (!tModel::TK_mod::is_constant_exposure()) {
+			throw std::invalid_argument("guts_projector_constant_exposure: exposure is not constant.");
+		}
+		state& s = static_cast<state& >(ps);
+		const std::size_t n = this->yt->size();
+		s.p.assign(n, 0);
+		s.damage.assign(n, 0);
+		for (std::size_t ytpos = 0; ytpos < n; ++ytpos) {
+			const double t = this->yt->at(ytpos);
+			s.damage[ytpos] = tModel::TK_mod::calculate_constant_exposure_damage(t);
+			s.p[ytpos] = tModel::TD_mod::calculate_constant_exposure_survival(
+				s.damage[ytpos],
+				[this, t](const double z) {return this->calculate_constant_exposure_damage_excess(z, t);},
+				t
+			);
+		}
+		if ( s.p.at(0) <= 0.0 ) {
+			// should never happen with well defined parameters
+			throw std::underflow_error("Numeric underflow: Survival cannot be calculated for given parameter values." );
 		}
+		for (std::size_t ytpos = n - 1; ytpos > 0; --ytpos) {
+			s.p[ytpos] /= s.p[0];
+		}
+		s.p[0] = 1;
+	}
+	std::vector<double > get_damage(const state& s) const {return s.damage;}
+	std::vector<double > get_damage_time(const state&) const {
+		return std::vector<double >(this->yt->begin(), this->yt->end());
 	}
+protected:
+	void gather_effect_per_time_step(typename parent::state&, const double, const double) const override {}
+};
+
+/**
+ * \brief constant-exposure projector of the model of a projector
+ * \details type is guts_projector_constant_exposure with the model, time and survival 
+ * types of tProjector (e.g. guts_projector or guts_projector_fastIT).
+ */
+template<typename tProjector >
+struct constant_exposure_projector;
+
+template<template<typename, typename, typename > class tProjector, typename tModel, typename tt, typename tSurvival >
+struct constant_exposure_projector<tProjector<tModel, tt, tSurvival > > {
+	typedef guts_projector_constant_exposure<tModel, tt, tSurvival > type;
 };
 
 template<typename tProjection, typename tmeasured_survivors >
   double calculate_loglikelihood(const tProjection& p, const tmeasured_survivors& y) {
+    GUTS_PHASE(loglikelihood);
     std::size_t diffy;
     double diffS;
     double loglik;
@@ -261,6 +570,7 @@ template<typename tProjection, typename tmeasured_survivors >
       if (back(p) == 0.0) {
         return -std::numeric_limits<double >::infinity(); 
       } else {
+        GUTS_COUNT(exp_log_calls);
         loglik = back(y) * std::log(back(p));
       }
     } else {
@@ -273,6 +583,7 @@ template<typename tProjection, typename tmeasured_survivors >
         if (diffS == 0.0) {
           return -std::numeric_limits<double >::infinity();
         }
+        GUTS_COUNT(exp_log_calls);
         loglik += static_cast<double>(diffy) * std::log(diffS);
       }
     } 
@@ -281,11 +592,13 @@ template<typename tProjection, typename tmeasured_survivors >
 
 template<typename tProjection, typename tmeasured_survivors >
   double calculate_SPPE(const tProjection& p, const tmeasured_survivors& y) {
+    GUTS_PHASE(loglikelihood);
     return (static_cast<double>(back(y)) / static_cast<double>(front(y)) - back(p)) * 100.0;
   }
 
 template<typename tProjection, typename tmeasured_survivors >
   double calculate_sum_of_squares(const tProjection& p, const tmeasured_survivors& y) {
+    GUTS_PHASE(loglikelihood);
     double sum_of_squares = 0.0;
     double diff;
     
@@ -298,4 +611,48 @@ template<typename tProjection, typename tmeasured_survivors >
     return sum_of_squares;
   }
 
+/**
+ * \brief scores many replicates of survivors with one projection
+ * \details Calculates calculate_loglikelihood(), calculate_SPPE() and
+ * calculate_sum_of_squares() for each replicate. The logarithms of the survival
+ * differences are calculated once per survival interval; replicates are scored in
+ * one pass per survival time.
+ * \param[in] p survival probabilities at the survival times
+ * \param[in] y survivors, column-major with one row per replicate and one column per survival time
+ * \param[in] R number of replicates
+ * \param[out] LL, SPPE, squares one value per replicate
+ */
+template<typename tProjection >
+  void score_survivor_replicates(const tProjection& p, const double* y, const std::size_t R,
+      double* LL, double* SPPE, double* squares) {
+    GUTS_PHASE(loglikelihood);
+    GUTS_COUNT_N(exp_log_calls, p.size());
+    const std::size_t n = p.size();
+    const double* y0 = y;
+    const double* y_end = y + (n - 1) * R;
+    const double p_end = p.at(n - 1);
+    for (std::size_t r = 0; r < R; ++r) {
+      LL[r] = y_end[r] > 0 ? (p_end == 0.0 ? -std::numeric_limits<double >::infinity() : y_end[r] * std::log(p_end)) : 0.0;
+      SPPE[r] = (y_end[r] / y0[r] - p_end) * 100.0;
+      squares[r] = 0.0;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      const double* yi = y + i * R;
+      if (i > 0) {
+        const double diffS = p.at(i-1) - p.at(i);
+        const double log_diffS = diffS == 0.0 ? -std::numeric_limits<double >::infinity() : std::log(diffS);
+        const double* y_previous = yi - R;
+        for (std::size_t r = 0; r < R; ++r) {
+          const double diffy = y_previous[r] - yi[r];
+          if (diffy > 0) LL[r] += diffy * log_diffS;
+        }
+      }
+      const double pi = p.at(i);
+      for (std::size_t r = 0; r < R; ++r) {
+        const double diff = yi[r] - y0[r] * pi;
+        squares[r] += diff * diff;
+      }
+    }
+  }
+
 #endif //GUTS_BASE_H_
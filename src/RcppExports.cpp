@@ -11,20 +11,282 @@ Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
 // guts_engine
-void guts_engine(Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::Nullable<Rcpp::NumericVector > z_dist);
+void guts_engine(Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject z_dist);
 RcppExport SEXP _GUTS_guts_engine(SEXP gobjSEXP, SEXP parSEXP, SEXP z_distSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
-    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector > >::type z_dist(z_distSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
     guts_engine(gobj, par, z_dist);
     return R_NilValue;
 END_RCPP
 }
 
+// guts_engine_models
+Rcpp::NumericVector guts_engine_models(Rcpp::List gobjs, Rcpp::List pars, Rcpp::List z_dists);
+RcppExport SEXP _GUTS_guts_engine_models(SEXP gobjsSEXP, SEXP parsSEXP, SEXP z_distsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobjs(gobjsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type pars(parsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type z_dists(z_distsSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_models(gobjs, pars, z_dists));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_batch
+Rcpp::List guts_engine_batch(Rcpp::List gobj, Rcpp::NumericMatrix par, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_batch(SEXP gobjSEXP, SEXP parSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type par(parSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_batch(gobj, par, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_compress_distribution
+Rcpp::List guts_compress_distribution(Rcpp::NumericVector x, const double max_cdf_error);
+RcppExport SEXP _GUTS_guts_compress_distribution(SEXP xSEXP, SEXP max_cdf_errorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const double >::type max_cdf_error(max_cdf_errorSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_compress_distribution(x, max_cdf_error));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_profiles
+Rcpp::List guts_engine_profiles(Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject profiles, Rcpp::NumericVector x, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_profiles(SEXP gobjSEXP, SEXP parSEXP, SEXP profilesSEXP, SEXP xSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type profiles(profilesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_profiles(gobj, par, profiles, x, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_scenarios
+Rcpp::List guts_engine_scenarios(Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject profiles, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_scenarios(SEXP gobjSEXP, SEXP parSEXP, SEXP profilesSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type profiles(profilesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_scenarios(gobj, par, profiles, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_write_store
+void guts_write_store(const std::string file, Rcpp::NumericVector Ct, Rcpp::NumericVector C, Rcpp::NumericVector offsets);
+RcppExport SEXP _GUTS_guts_write_store(SEXP fileSEXP, SEXP CtSEXP, SEXP CSEXP, SEXP offsetsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type Ct(CtSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type C(CSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type offsets(offsetsSEXP);
+    guts_write_store(file, Ct, C, offsets);
+    return R_NilValue;
+END_RCPP
+}
+
+// guts_read_store
+Rcpp::List guts_read_store(const std::string file);
+RcppExport SEXP _GUTS_guts_read_store(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_read_store(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_live_create
+SEXP guts_engine_live_create(Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_live_create(SEXP gobjSEXP, SEXP parSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_live_create(gobj, par, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_live_append
+Rcpp::List guts_engine_live_append(SEXP live, Rcpp::NumericVector Ct, Rcpp::NumericVector C, Rcpp::NumericVector yt, Rcpp::NumericVector y);
+RcppExport SEXP _GUTS_guts_engine_live_append(SEXP liveSEXP, SEXP CtSEXP, SEXP CSEXP, SEXP ytSEXP, SEXP ySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type live(liveSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type Ct(CtSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type C(CSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type yt(ytSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_live_append(live, Ct, C, yt, y));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_live_result
+Rcpp::List guts_engine_live_result(SEXP live);
+RcppExport SEXP _GUTS_guts_engine_live_result(SEXP liveSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type live(liveSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_live_result(live));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_windows
+Rcpp::List guts_engine_windows(Rcpp::List gobj, Rcpp::NumericVector par, const double window, const std::size_t steps_per_window, const std::size_t steps_per_shift, Rcpp::NumericVector x, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_windows(SEXP gobjSEXP, SEXP parSEXP, SEXP windowSEXP, SEXP steps_per_windowSEXP, SEXP steps_per_shiftSEXP, SEXP xSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< const double >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< const std::size_t >::type steps_per_window(steps_per_windowSEXP);
+    Rcpp::traits::input_parameter< const std::size_t >::type steps_per_shift(steps_per_shiftSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_windows(gobj, par, window, steps_per_window, steps_per_shift, x, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_loglikelihood
+double guts_engine_loglikelihood(Rcpp::List gobj, Rcpp::NumericVector par, const double LL_min, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_loglikelihood(SEXP gobjSEXP, SEXP parSEXP, SEXP LL_minSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< const double >::type LL_min(LL_minSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_loglikelihood(gobj, par, LL_min, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_rescore
+Rcpp::List guts_engine_rescore(Rcpp::NumericMatrix S, Rcpp::NumericMatrix y);
+RcppExport SEXP _GUTS_guts_engine_rescore(SEXP SSEXP, SEXP ySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type S(SSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type y(ySEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_rescore(S, y));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_joint
+Rcpp::NumericVector guts_engine_joint(Rcpp::List gobjs, Rcpp::NumericVector par, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_joint(SEXP gobjsSEXP, SEXP parSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobjs(gobjsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_joint(gobjs, par, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_instrumentation
+Rcpp::List guts_engine_instrumentation(const bool reset);
+RcppExport SEXP _GUTS_guts_engine_instrumentation(SEXP resetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_instrumentation(reset));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_simulate
+Rcpp::IntegerMatrix guts_engine_simulate(Rcpp::List gobj, Rcpp::NumericMatrix par, const int replicates, const int individuals, const double seed, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_simulate(SEXP gobjSEXP, SEXP parSEXP, SEXP replicatesSEXP, SEXP individualsSEXP, SEXP seedSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type par(parSEXP);
+    Rcpp::traits::input_parameter< const int >::type replicates(replicatesSEXP);
+    Rcpp::traits::input_parameter< const int >::type individuals(individualsSEXP);
+    Rcpp::traits::input_parameter< const double >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_simulate(gobj, par, replicates, individuals, seed, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// guts_engine_sensitivity
+Rcpp::List guts_engine_sensitivity(Rcpp::List gobj, Rcpp::NumericVector par, const bool loglikelihood, const bool with_Ct, Rcpp::RObject z_dist);
+RcppExport SEXP _GUTS_guts_engine_sensitivity(SEXP gobjSEXP, SEXP parSEXP, SEXP loglikelihoodSEXP, SEXP with_CtSEXP, SEXP z_distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type gobj(gobjSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type par(parSEXP);
+    Rcpp::traits::input_parameter< const bool >::type loglikelihood(loglikelihoodSEXP);
+    Rcpp::traits::input_parameter< const bool >::type with_Ct(with_CtSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type z_dist(z_distSEXP);
+    rcpp_result_gen = Rcpp::wrap(guts_engine_sensitivity(gobj, par, loglikelihood, with_Ct, z_dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+
 static const R_CallMethodDef CallEntries[] = {
     {"_GUTS_guts_engine", (DL_FUNC) &_GUTS_guts_engine, 3},
+    {"_GUTS_guts_engine_models", (DL_FUNC) &_GUTS_guts_engine_models, 3},
+    {"_GUTS_guts_engine_batch", (DL_FUNC) &_GUTS_guts_engine_batch, 3},
+    {"_GUTS_guts_compress_distribution", (DL_FUNC) &_GUTS_guts_compress_distribution, 2},
+    {"_GUTS_guts_engine_profiles", (DL_FUNC) &_GUTS_guts_engine_profiles, 5},
+    {"_GUTS_guts_engine_scenarios", (DL_FUNC) &_GUTS_guts_engine_scenarios, 4},
+    {"_GUTS_guts_write_store", (DL_FUNC) &_GUTS_guts_write_store, 4},
+    {"_GUTS_guts_read_store", (DL_FUNC) &_GUTS_guts_read_store, 1},
+    {"_GUTS_guts_engine_live_create", (DL_FUNC) &_GUTS_guts_engine_live_create, 3},
+    {"_GUTS_guts_engine_live_append", (DL_FUNC) &_GUTS_guts_engine_live_append, 5},
+    {"_GUTS_guts_engine_live_result", (DL_FUNC) &_GUTS_guts_engine_live_result, 1},
+    {"_GUTS_guts_engine_windows", (DL_FUNC) &_GUTS_guts_engine_windows, 7},
+    {"_GUTS_guts_engine_loglikelihood", (DL_FUNC) &_GUTS_guts_engine_loglikelihood, 4},
+    {"_GUTS_guts_engine_rescore", (DL_FUNC) &_GUTS_guts_engine_rescore, 2},
+    {"_GUTS_guts_engine_joint", (DL_FUNC) &_GUTS_guts_engine_joint, 3},
+    {"_GUTS_guts_engine_instrumentation", (DL_FUNC) &_GUTS_guts_engine_instrumentation, 1},
+    {"_GUTS_guts_engine_simulate", (DL_FUNC) &_GUTS_guts_engine_simulate, 6},
+    {"_GUTS_guts_engine_sensitivity", (DL_FUNC) &_GUTS_guts_engine_sensitivity, 5},
     {NULL, NULL, 0}
 };
 
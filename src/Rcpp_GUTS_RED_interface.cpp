@@ -12,10 +12,28 @@
 
 #include <Rcpp.h>
 #include <cctype>
+#include <cstdint>
 #include <iterator>
+#include <memory>
+#include <unordered_map>
 #include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "GUTS_RED.h"
+#include "GUTS_RED_adjoint.h"
+#include "GUTS_RED_IT_lanes.h"
+#include "GUTS_RED_SD_lanes.h"
+#include "GUTS_RED_live.h"
+#include "GUTS_RED_profiles.h"
+#include "GUTS_RED_simulation.h"
+#include "GUTS_RED_windows.h"
+#include "content_hash.h"
+#include "exposure_store.h"
 #include "external_data.h"
+#include "instrumentation.h"
 
 typedef Rcpp::NumericVector ttime;
 typedef Rcpp::NumericVector tconc;
@@ -54,15 +72,17 @@ struct Rcpp_fast_projector :
         this->initialize(data);
     }
     Rcpp::NumericVector predict(const tpara& parameters) {
-        tsurv survival_probabilities = project(*this, parameters);
+        tsurv survival_probabilities = project(*this, parameters, run);
         return  Rcpp::wrap(survival_probabilities);
     }
-    std::vector<double > get_D() const {
-    	return this -> get_damage();
+    std::vector<double > get_D() {
+    	return this -> get_damage(run);
     }
-    std::vector<double > get_Dt() const {
-    	return this -> get_damage_time();
+    std::vector<double > get_Dt() {
+    	return this -> get_damage_time(run);
     }
+    ///state of the last projection
+    typename Rcpp_fast_projector::state run;
 };
 
 template<typename TD_mod >
@@ -77,15 +97,39 @@ struct Rcpp_projector :
         this->initialize(data);
     }
     Rcpp::NumericVector predict(const tpara& parameters) {
-        tsurv survival_probabilities = project(*this, parameters);
+        tsurv survival_probabilities = project(*this, parameters, run);
+        return  Rcpp::wrap(survival_probabilities);
+    }
+    std::vector<double > get_D() {
+      return this -> get_damage(run);
+    }
+    std::vector<double > get_Dt() {
+      return this -> get_damage_time(run);
+    }
+    ///state of the last projection
+    typename Rcpp_projector::state run;
+};
+
+template<typename TD_mod >
+struct Rcpp_constant_exposure_projector : 
+    public guts_projector_constant_exposure<guts_RED<ttime, tconc, TD_mod, tpara >, ttime, tsurv > {
+    template<bool add_time_discretization, bool add_distribution_sample_size >
+    void add_data(
+            const external_data<ttime, tconc, add_time_discretization, add_distribution_sample_size >& data) {
+        this->initialize(data);
+    }
+    Rcpp::NumericVector predict(const tpara& parameters) {
+        tsurv survival_probabilities = project(*this, parameters, run);
         return  Rcpp::wrap(survival_probabilities);
     }
-    std::vector<double > get_D() const {
-      return this -> get_damage();
+    std::vector<double > get_D() {
+      return this -> get_damage(run);
     }
-    std::vector<double > get_Dt() const {
-      return this -> get_damage_time();
+    std::vector<double > get_Dt() {
+      return this -> get_damage_time(run);
     }
+    ///state of the last projection
+    typename Rcpp_constant_exposure_projector::state run;
 };
 
 typedef external_data<ttime, tconc, true, true > ext_dat_timediscrete_thresholddistdiscrete;
@@ -93,38 +137,96 @@ typedef external_data<ttime, tconc, true, false > ext_dat_timediscrete;
 typedef external_data<ttime, tconc, false, true > ext_dat_thresholddistdiscrete;
 typedef external_data<ttime, tconc, false, false > ext_dat;
 
-// Appends the random distribution of threshold values to the parameter vector
+// Sorted threshold sample for dist = 'external'
 // 
-// \code{z_dist} is transformed to \code{Rcpp::NumericVector} and sorted.
+// \code{z_dist} is either an unsorted numeric vector, which is copied and sorted, 
+// or an object created by \code{guts_external_distribution()}, which holds sorted 
+// (and possibly compressed) values with probability weights. Vectors of the 
+// object are used without copying.
 // If \code{z_dist == NULL} an error is thrown
 //
-// @param par GUTS-RED parameters
-// @param z_dist unsorted random distribution of threshold values
-// 
-// @return the combined vector
-Rcpp::NumericVector combine_par_and_external_distribution(
-    Rcpp::NumericVector par,
-    Rcpp::Nullable<Rcpp::NumericVector > z_dist
-    ) {
-  if (z_dist.isNull()) Rcpp::stop("dist = external: Need threshold sample");
-  Rcpp::NumericVector zd(Rcpp::clone(z_dist));
-  zd.sort();
-  Rcpp::NumericVector all_values(par.size() + zd.size());
-  std::copy(par.begin(), par.end(), all_values.begin());
-  std::copy(zd.begin(), zd.end(), all_values.begin() + par.size());
-  return all_values;
-}
-
-template<typename tProjector, typename tData, typename tPara >
-void project_to_gobj(Rcpp::List gobj, tProjector& proj, const tData& dat, const tPara& par) {
+// Called with a projector (or model), the sample is set as threshold distribution.
+struct external_sample {
+  explicit external_sample(Rcpp::RObject z_dist) {
+    if (z_dist.isNULL()) Rcpp::stop("dist = external: Need threshold sample");
+    if (z_dist.inherits("GUTS_external_distribution")) {
+      Rcpp::List zl(z_dist);
+      z = zl["z"];
+      w = zl["w"];
+      W = zl["W"];
+      n = Rcpp::as<double >(z_dist.attr("n"));
+    } else {
+      z = Rcpp::clone(Rcpp::NumericVector(z_dist));
+      z.sort();
+      n = z.size();
+    }
+  }
+  template<typename tModel >
+  void operator()(tModel& model) const {
+    typedef typename std::remove_reference<decltype(model.samp) >::type::sample_type tz;
+    model.samp.set_variates(as_sample(z, static_cast<tz* >(nullptr)), as_sample(w, static_cast<tz* >(nullptr)), as_sample(W, static_cast<tz* >(nullptr)), n);
+  }
+  static const tpara& as_sample(const tpara& v, tpara*) {return v;}
+  static std::vector<double > as_sample(const tpara& v, std::vector<double >*) {return std::vector<double >(v.begin(), v.end());}
+  tpara z;
+  tpara w;
+  tpara W;
+  ///size of the raw sample
+  double n;
+};
+
+// Leaves the threshold distribution of a projector (or model) unchanged
+struct no_external_sample {
+  template<typename tModel >
+  void operator()(tModel&) const {}
+};
+
+// [[Rcpp::export]]
+Rcpp::List guts_compress_distribution(Rcpp::NumericVector x, const double max_cdf_error) {
+  if (x.size() == 0) Rcpp::stop("Need a non-empty threshold sample.");
+  Rcpp::NumericVector xs(Rcpp::clone(x));
+  xs.sort();
+  std::vector<double > z, w, W;
+  compress_sorted_sample(xs, max_cdf_error, z, w, W);
+  return Rcpp::List::create(
+    Rcpp::Named("z") = z, 
+    Rcpp::Named("w") = w, 
+    Rcpp::Named("W") = W
+  );
+}
+
+// Number of threads within one evaluation (attribute set by guts_setup(); defaults to 1)
+std::size_t get_num_threads(Rcpp::List gobj) {
+  if (!gobj.hasAttribute("num_threads")) return 1;
+  return Rcpp::as<std::size_t >(gobj.attr("num_threads"));
+}
+
+template<typename tProjector, typename tData, typename tPara, typename tSample >
+void project_to_gobj(Rcpp::List gobj, tProjector& proj, const tData& dat, const tPara& par, const tSample& sample) {
   proj.add_data(dat);
+  proj.set_num_threads(get_num_threads(gobj));
+  sample(proj);
   gobj["S"] = proj.predict(par);
   gobj["D"] = proj.get_D();
   gobj["Dt"] = proj.get_Dt();
 }
 
+// Projects with the closed-form solutions if exposure is constant, 
+// otherwise with projector type tProjector
+template<template<typename > class tProjector, typename TD_mod, typename tData, typename tPara, typename tSample = no_external_sample >
+void project_to_gobj(Rcpp::List gobj, const tData& dat, const tPara& par, const tSample& sample = tSample()) {
+  if (is_constant_exposure(dat)) {
+    Rcpp_constant_exposure_projector<TD_mod > proj;
+    project_to_gobj(gobj, proj, dat, par, sample);
+  } else {
+    tProjector<TD_mod > proj;
+    project_to_gobj(gobj, proj, dat, par, sample);
+  }
+}
+
 // [[Rcpp::export]]
-void guts_engine( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::Nullable<Rcpp::NumericVector > z_dist = R_NilValue) {
+void guts_engine( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject z_dist = R_NilValue) {
+  GUTS_PHASE(marshalling);
   if (!gobj.inherits("GUTS")) {
     Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
   }
@@ -138,21 +240,20 @@ void guts_engine( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::Nullable<Rcpp:
     switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
     case dist_type::LOGLOGISTIC : {
       if (par.size() != par_len) Rcpp::stop("IT-loglogistic: Need parameters hb, kd, mn and beta"); 
-      Rcpp_fast_projector<TD_IT_loglogistic > proj;
-      project_to_gobj(gobj, proj, dat, Rcpp::NumericVector::create(par[0], par[1], NA_REAL, par[2], par[3]));
+      project_to_gobj<Rcpp_fast_projector, TD_IT_loglogistic >(
+        gobj, dat, Rcpp::NumericVector::create(par[0], par[1], NA_REAL, par[2], par[3]));
       break;
     }
     case dist_type::LOGNORMAL : {
       if (par.size() != par_len) Rcpp::stop("IT-lognormal: Need parameters hb, kd, mn and sd"); 
-      Rcpp_fast_projector<TD_IT_lognormal > proj;
-      project_to_gobj(gobj, proj, dat, Rcpp::NumericVector::create(par[0], par[1], NA_REAL, par[2], par[3]));
+      project_to_gobj<Rcpp_fast_projector, TD_IT_lognormal >(
+        gobj, dat, Rcpp::NumericVector::create(par[0], par[1], NA_REAL, par[2], par[3]));
       break;
     }
     case dist_type::EXTERNAL : {
       if (par.size() != par_len) Rcpp::stop("IT-external: Need parameters hb and kd"); 
-      Rcpp_fast_projector<TD<random_sample<tpara > , 'I' > > proj;
-      project_to_gobj(gobj, proj, dat, 
-                      combine_par_and_external_distribution(par, z_dist)
+      project_to_gobj<Rcpp_fast_projector, TD<random_sample<tpara > , 'I' > >(
+        gobj, dat, par, external_sample(z_dist)
       );
       break;
     }
@@ -166,8 +267,7 @@ void guts_engine( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::Nullable<Rcpp:
     if (par.size() != par_len) Rcpp::stop("SD: Need parameters hb, kd, kk and mn"); 
     ext_dat_timediscrete dat;
     dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
-    Rcpp_projector<TD_SD > proj;
-    project_to_gobj(gobj, proj, dat, par);
+    project_to_gobj<Rcpp_projector, TD_SD >(gobj, dat, par);
     break;
   }
   case TD_type::PROPER : {
@@ -176,33 +276,29 @@ void guts_engine( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::Nullable<Rcpp:
       if (par.size() != par_len) Rcpp::stop("Proper-loglogistic: Need parameters hb, kd, kk, mn and beta"); 
       ext_dat_timediscrete_thresholddistdiscrete dat;
       dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
-      Rcpp_projector<TD_proper_loglogistic > proj;
-      project_to_gobj(gobj, proj, dat, par);
+      project_to_gobj<Rcpp_projector, TD_proper_loglogistic >(gobj, dat, par);
       break;
     } 
     case dist_type::LOGNORMAL : {
       if (par.size() != par_len) Rcpp::stop("Proper-lognormal: Need parameters hb, kd, kk, mn and sd"); 
       ext_dat_timediscrete_thresholddistdiscrete dat;
       dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
-      Rcpp_projector<TD_proper_lognormal > proj;
-      project_to_gobj(gobj, proj, dat, par);
+      project_to_gobj<Rcpp_projector, TD_proper_lognormal >(gobj, dat, par);
       break;
     }
     case dist_type::DELTA : {
       if (par.size() != par_len) Rcpp::stop("Proper-delta: Need parameters hb, kd, kk and mn"); 
       ext_dat_timediscrete dat;
       dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
-      Rcpp_projector<TD_proper_delta > proj;
-      project_to_gobj(gobj, proj, dat, par);
+      project_to_gobj<Rcpp_projector, TD_proper_delta >(gobj, dat, par);
       break;
     } 
     case dist_type::EXTERNAL : {
       if (par.size() != par_len) Rcpp::stop("Proper-external: Need parameters hb, kd and kk"); 
       ext_dat_timediscrete dat;
       dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
-      Rcpp_projector<TD<random_sample<tpara >, 'P' > > proj;
-      project_to_gobj(
-        gobj, proj, dat, combine_par_and_external_distribution(par, z_dist)
+      project_to_gobj<Rcpp_projector, TD<random_sample<tpara >, 'P' > >(
+        gobj, dat, par, external_sample(z_dist)
       );
       break;
     }
@@ -223,3 +319,1043 @@ void guts_engine( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::Nullable<Rcpp:
   gobj["SPPE"] = calculate_SPPE<tsurv, tobssurv >(gobj["S"], gobj["y"]);
   gobj["squares"] = calculate_sum_of_squares<tsurv, tobssurv >(gobj["S"], gobj["y"]);
 }
+
+// Counters and phase timers accumulated since the last reset (see instrumentation.h);
+// all zero unless the package was compiled with -DGUTS_INSTRUMENTATION.
+// [[Rcpp::export]]
+Rcpp::List guts_engine_instrumentation(const bool reset) {
+  using namespace guts_instrumentation;
+  Rcpp::NumericVector counts(num_counters);
+  Rcpp::CharacterVector count_names(num_counters);
+  for (std::size_t c = 0; c < num_counters; ++c) {
+    counts[c] = static_cast<double >(get_count(static_cast<counter >(c)));
+    count_names[c] = counter_names[c];
+  }
+  counts.attr("names") = count_names;
+  Rcpp::NumericVector seconds(num_phases), calls(num_phases);
+  Rcpp::CharacterVector names(num_phases);
+  for (std::size_t p = 0; p < num_phases; ++p) {
+    seconds[p] = get_seconds(static_cast<phase >(p));
+    calls[p] = static_cast<double >(get_calls(static_cast<phase >(p)));
+    names[p] = phase_names[p];
+  }
+  if (reset) guts_instrumentation::reset();
+  return Rcpp::List::create(
+    Rcpp::Named("enabled") = enabled(),
+    Rcpp::Named("counts") = counts,
+    Rcpp::Named("phases") = Rcpp::DataFrame::create(
+      Rcpp::Named("phase") = names,
+      Rcpp::Named("seconds") = seconds,
+      Rcpp::Named("calls") = calls,
+      Rcpp::Named("stringsAsFactors") = false
+    )
+  );
+}
+
+// Fields of a GUTS object a projection depends on (besides model, distribution and parameters)
+const char* const projection_fields[] = {"Ct", "C", "yt", "M", "N", "SVR"};
+
+// Content hash of the projection data of gobj
+std::uint64_t projection_hash(Rcpp::List gobj) {
+  content_hash h;
+  h.add(static_cast<std::uint64_t >(static_cast<unsigned >(gobj.attr("TD_type"))));
+  h.add(static_cast<std::uint64_t >(static_cast<unsigned >(gobj.attr("dist_type"))));
+  for (auto field : projection_fields) {
+    Rcpp::NumericVector values = gobj[field];
+    h.add(values.begin(), values.end());
+  }
+  return h.value();
+}
+
+// Checks whether two GUTS objects have equal projections for equal parameters
+bool equal_projection_data(Rcpp::List a, Rcpp::List b) {
+  if (static_cast<unsigned >(a.attr("TD_type")) != static_cast<unsigned >(b.attr("TD_type")) ||
+      static_cast<unsigned >(a.attr("dist_type")) != static_cast<unsigned >(b.attr("dist_type"))) {
+    return false;
+  }
+  for (auto field : projection_fields) {
+    Rcpp::NumericVector values_a = a[field];
+    Rcpp::NumericVector values_b = b[field];
+    if (values_a.size() != values_b.size() || !std::equal(values_a.begin(), values_a.end(), values_b.begin(),
+        [](const double x, const double y) {return x == y || (std::isnan(x) && std::isnan(y));})) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericVector guts_engine_joint( Rcpp::List gobjs, Rcpp::NumericVector par, Rcpp::RObject z_dist = R_NilValue) {
+  // projected GUTS objects by content hash
+  std::unordered_map<std::uint64_t, std::vector<vec_size_t > > projected;
+  Rcpp::NumericVector LL(gobjs.size());
+  vec_size_t num_projections = 0;
+  for (vec_size_t i = 0; i < gobjs.size(); ++i) {
+    Rcpp::List gobj = gobjs[i];
+    if (!gobj.inherits("GUTS")) {
+      Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+    }
+    std::vector<vec_size_t >& candidates = projected[projection_hash(gobj)];
+    auto source = std::find_if(candidates.begin(), candidates.end(),
+        [&gobjs, &gobj](const vec_size_t j) {return equal_projection_data(gobjs[j], gobj);});
+    if (source == candidates.end()) {
+      guts_engine(gobj, par, z_dist);
+      candidates.push_back(i);
+      ++num_projections;
+    } else {
+      // share the projection, score the survivors of gobj
+      Rcpp::List gobj_source = gobjs[*source];
+      const tsurv S = gobj_source["S"];
+      gobj["S"] = S;
+      gobj["D"] = Rcpp::clone(Rcpp::NumericVector(gobj_source["D"]));
+      gobj["Dt"] = Rcpp::clone(Rcpp::NumericVector(gobj_source["Dt"]));
+      gobj["par"] = par;
+      gobj["external_dist"] = z_dist;
+      gobj["LL"] = calculate_loglikelihood<tsurv, tobssurv >(S, gobj["y"]);
+      gobj["SPPE"] = calculate_SPPE<tsurv, tobssurv >(S, gobj["y"]);
+      gobj["squares"] = calculate_sum_of_squares<tsurv, tobssurv >(S, gobj["y"]);
+    }
+    LL[i] = gobj["LL"];
+  }
+  LL.attr("projections") = num_projections;
+  return LL;
+}
+
+// TD model fed by the fan-out projector
+struct Rcpp_fan_out_consumer_base {
+  virtual ~Rcpp_fan_out_consumer_base() {}
+  virtual const TD_base& TD() const = 0;
+};
+
+template<typename TD_mod >
+struct Rcpp_fan_out_consumer : public Rcpp_fan_out_consumer_base {
+  template<typename tData, typename tSample = no_external_sample >
+  Rcpp_fan_out_consumer(const tData& dat, const tpara& par, const std::size_t num_threads, const tSample& sample = tSample()) {
+    model.initialize(dat);
+    model.set_num_threads(num_threads);
+    sample(model);
+    model.set_parameters(par);
+    model.initialize_from_parameters();
+  }
+  const TD_base& TD() const override {return model;}
+  guts_RED<ttime, tconc, TD_mod, tpara > model;
+};
+
+// Creates the TD model for one SD or Proper GUTS object on a time grid with M steps
+std::unique_ptr<Rcpp_fan_out_consumer_base > make_fan_out_consumer(
+    Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject z_dist, const std::size_t M) {
+  tpara par_obj = gobj["par"];
+  vec_size_t par_len = par_obj.length();
+  if (par.size() != par_len) Rcpp::stop("Wrong number of parameters for model '" + Rcpp::as<std::string >(gobj["model"]) + "'");
+  ext_dat_timediscrete_thresholddistdiscrete dat;
+  std::size_t N = static_cast<unsigned >(gobj.attr("TD_type")) == TD_type::PROPER ? Rcpp::as<std::size_t >(gobj["N"]) : 0;
+  dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], M, N, gobj["SVR"]);
+  const std::size_t num_threads = get_num_threads(gobj);
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::SD :
+    return std::unique_ptr<Rcpp_fan_out_consumer_base >(new Rcpp_fan_out_consumer<TD_SD >(dat, par, num_threads));
+  case TD_type::PROPER : {
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC :
+      return std::unique_ptr<Rcpp_fan_out_consumer_base >(new Rcpp_fan_out_consumer<TD_proper_loglogistic >(dat, par, num_threads));
+    case dist_type::LOGNORMAL :
+      return std::unique_ptr<Rcpp_fan_out_consumer_base >(new Rcpp_fan_out_consumer<TD_proper_lognormal >(dat, par, num_threads));
+    case dist_type::DELTA :
+      return std::unique_ptr<Rcpp_fan_out_consumer_base >(new Rcpp_fan_out_consumer<TD_proper_delta >(dat, par, num_threads));
+    case dist_type::EXTERNAL :
+      return std::unique_ptr<Rcpp_fan_out_consumer_base >(new Rcpp_fan_out_consumer<TD<random_sample<tpara >, 'P' > >(
+          dat, par, num_threads, external_sample(z_dist)));
+    default :
+      Rcpp::stop("model 'Proper' needs one of the distributions 'loglogistic', 'lognormal', 'delta' or 'external'");
+    }
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper' or 'SD'");
+  }
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericVector guts_engine_models( Rcpp::List gobjs, Rcpp::List pars, Rcpp::List z_dists) {
+  if (gobjs.size() != pars.size() || gobjs.size() != z_dists.size()) {
+    Rcpp::stop("Need one parameter vector and one external distribution (or NULL) per GUTS object.");
+  }
+  if (gobjs.size() == 0) Rcpp::stop("Need at least one GUTS object.");
+  Rcpp::NumericVector LL(gobjs.size());
+  // IT models (fastIT) and constant exposure (closed form) are not projected on the time grid
+  Rcpp::List gobj = gobjs[0];
+  ext_dat dat_exposure;
+  dat_exposure.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["SVR"]);
+  const bool constant_exposure = is_constant_exposure(dat_exposure);
+  std::vector<vec_size_t > on_grid;
+  for (vec_size_t i = 0; i < gobjs.size(); ++i) {
+    Rcpp::List gobj_i = gobjs[i];
+    if (!gobj_i.inherits("GUTS")) {
+      Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+    }
+    if (constant_exposure || static_cast<unsigned >(gobj_i.attr("TD_type")) == TD_type::IT) {
+      guts_engine(gobj_i, pars[i], z_dists[i]);
+      LL[i] = gobj_i["LL"];
+    } else {
+      on_grid.push_back(i);
+    }
+  }
+  if (on_grid.empty()) return LL;
+
+  // SD and Proper models share the damage on the time grid
+  Rcpp::List gobj_grid = gobjs[on_grid[0]];
+  const std::size_t M = Rcpp::as<std::size_t >(gobj_grid["M"]);
+  std::vector<std::unique_ptr<Rcpp_fan_out_consumer_base > > models;
+  for (const vec_size_t i : on_grid) {
+    models.push_back(make_fan_out_consumer(gobjs[i], pars[i], z_dists[i], M));
+  }
+  Rcpp::NumericVector par = pars[on_grid[0]];
+  ext_dat_timediscrete dat;
+  dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], M, gobj["SVR"]);
+  guts_projector_fan_out<TK_RED<ttime, tconc >, ttime, tsurv > proj;
+  proj.initialize(dat);
+  proj.set_dominant_rate_constant(par[1]);
+  for (auto& model : models) proj.add_consumer(model->TD());
+  guts_projector_fan_out<TK_RED<ttime, tconc >, ttime, tsurv >::state run;
+  run_projection(proj, run);
+
+  tsurv S;
+  for (vec_size_t j = 0; j < on_grid.size(); ++j) {
+    const vec_size_t i = on_grid[j];
+    Rcpp::List gobj_i = gobjs[i];
+    proj.get_survival_projection(run, j, S);
+    gobj_i["S"] = S;
+    gobj_i["D"] = proj.get_damage(run);
+    gobj_i["Dt"] = proj.get_damage_time(run);
+    gobj_i["par"] = pars[i];
+    gobj_i["external_dist"] = z_dists[i];
+    LL[i] = calculate_loglikelihood<tsurv, tobssurv >(S, gobj_i["y"]);
+    gobj_i["LL"] = LL[i];
+    gobj_i["SPPE"] = calculate_SPPE<tsurv, tobssurv >(S, gobj_i["y"]);
+    gobj_i["squares"] = calculate_sum_of_squares<tsurv, tobssurv >(S, gobj_i["y"]);
+  }
+  return LL;
+}
+
+// Prepares one parameter set for the projector of the model type of gobj
+tpara prepare_parameters(Rcpp::List gobj, const tpara& par) {
+  tpara par_obj = gobj["par"];
+  if (par.size() != par_obj.length()) Rcpp::stop("Wrong number of parameters for model '" + Rcpp::as<std::string >(gobj["model"]) + "'");
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT :
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC :
+    case dist_type::LOGNORMAL :
+      return Rcpp::NumericVector::create(par[0], par[1], NA_REAL, par[2], par[3]);
+    case dist_type::EXTERNAL :
+      return par;
+    default :
+      Rcpp::stop("model 'IT' needs one of the distributions 'loglogistic', 'lognormal' or 'external'");
+    }
+  default :
+    return par;
+  }
+}
+
+// Projects survival for each parameter set (one row of the returned matrix) with one projector
+template<typename tProjector, typename tData, typename tSample >
+Rcpp::NumericMatrix project_batch(tProjector& proj, const tData& dat, const std::vector<tpara >& pars, const std::size_t num_threads, const tSample& sample) {
+  Rcpp::NumericMatrix S(pars.size(), dat.yt_size());
+  proj.add_data(dat);
+  proj.set_num_threads(num_threads);
+  sample(proj);
+  for (std::size_t i = 0; i < pars.size(); ++i) {
+    tsurv s = project(proj, pars[i]);
+    for (std::size_t j = 0; j < s.size(); ++j) S(i, j) = s[j];
+  }
+  return S;
+}
+
+template<template<typename > class tProjector, typename TD_mod, typename tData, typename tSample = no_external_sample >
+Rcpp::NumericMatrix project_batch(const tData& dat, const std::vector<tpara >& pars, const std::size_t num_threads, const tSample& sample = tSample()) {
+  if (is_constant_exposure(dat)) {
+    Rcpp_constant_exposure_projector<TD_mod > proj;
+    return project_batch(proj, dat, pars, num_threads, sample);
+  }
+  tProjector<TD_mod > proj;
+  return project_batch(proj, dat, pars, num_threads, sample);
+}
+
+// Projects survival for each parameter set in lanes of tLanes; blocks of lanes 
+// are distributed over the threads, with one lanes object per thread
+template<typename tLanes, typename tData >
+Rcpp::NumericMatrix project_lanes(const tData& dat, const std::vector<tpara >& pars, const std::size_t num_threads) {
+  const std::size_t W = tLanes::num_lanes();
+  const std::size_t P = pars.size();
+  const std::size_t B = (P + W - 1) / W;
+  const int T = static_cast<int >(std::max<std::size_t >(std::min(num_threads, B), 1));
+  std::vector<tLanes > lanes(T);
+  for (tLanes& l : lanes) l.initialize(dat);
+  const std::size_t n = dat.yt_size();
+  Rcpp::NumericMatrix S(P, n);
+  double* S_p = P > 0 ? &S[0] : nullptr;
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(T)
+#endif
+  for (int b = 0; b < static_cast<int >(B); ++b) {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num();
+#endif
+    const std::size_t i = static_cast<std::size_t >(b) * W;
+    std::array<tsurv, W > p;
+    // unused lanes repeat the last parameter set
+    for (std::size_t l = 0; l < W; ++l) lanes[t].set_parameters(l, pars[std::min(i + l, P - 1)]);
+    lanes[t].project_survival(p);
+    for (std::size_t l = 0; l < W && i + l < P; ++l) {
+      for (std::size_t j = 0; j < n; ++j) S_p[i + l + j * P] = p[l][j];
+    }
+  }
+  return S;
+}
+
+// SD with time-varying exposure: parameter sets are projected in lanes
+template<>
+Rcpp::NumericMatrix project_batch<Rcpp_projector, TD_SD, ext_dat_timediscrete, no_external_sample >(
+    const ext_dat_timediscrete& dat, const std::vector<tpara >& pars, const std::size_t num_threads, const no_external_sample& sample) {
+  if (is_constant_exposure(dat)) {
+    Rcpp_constant_exposure_projector<TD_SD > proj;
+    return project_batch(proj, dat, pars, num_threads, sample);
+  }
+  return project_lanes<guts_RED_SD_lanes<ttime, tconc > >(dat, pars, num_threads);
+}
+
+// IT with a threshold distribution and time-varying exposure: parameter sets are projected in lanes
+template<>
+Rcpp::NumericMatrix project_batch<Rcpp_fast_projector, TD_IT_loglogistic, ext_dat, no_external_sample >(
+    const ext_dat& dat, const std::vector<tpara >& pars, const std::size_t num_threads, const no_external_sample& sample) {
+  if (is_constant_exposure(dat)) {
+    Rcpp_constant_exposure_projector<TD_IT_loglogistic > proj;
+    return project_batch(proj, dat, pars, num_threads, sample);
+  }
+  return project_lanes<guts_RED_IT_lanes<ttime, tconc, loglogistic > >(dat, pars, num_threads);
+}
+
+template<>
+Rcpp::NumericMatrix project_batch<Rcpp_fast_projector, TD_IT_lognormal, ext_dat, no_external_sample >(
+    const ext_dat& dat, const std::vector<tpara >& pars, const std::size_t num_threads, const no_external_sample& sample) {
+  if (is_constant_exposure(dat)) {
+    Rcpp_constant_exposure_projector<TD_IT_lognormal > proj;
+    return project_batch(proj, dat, pars, num_threads, sample);
+  }
+  return project_lanes<guts_RED_IT_lanes<ttime, tconc, lognormal > >(dat, pars, num_threads);
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_batch( Rcpp::List gobj, Rcpp::NumericMatrix par, Rcpp::RObject z_dist = R_NilValue) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  std::vector<tpara > pars;
+  for (int i = 0; i < par.nrow(); ++i) {
+    tpara par_i = par.row(i);
+    pars.push_back(prepare_parameters(gobj, par_i));
+  }
+  const std::size_t num_threads = get_num_threads(gobj);
+  Rcpp::NumericMatrix S;
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT : {
+    ext_dat dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["SVR"]);
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC :
+      S = project_batch<Rcpp_fast_projector, TD_IT_loglogistic >(dat, pars, num_threads);
+      break;
+    case dist_type::LOGNORMAL :
+      S = project_batch<Rcpp_fast_projector, TD_IT_lognormal >(dat, pars, num_threads);
+      break;
+    default :
+      S = project_batch<Rcpp_fast_projector, TD<random_sample<tpara >, 'I' > >(dat, pars, num_threads, external_sample(z_dist));
+      break;
+    }
+    break;
+  }
+  case TD_type::SD : {
+    ext_dat_timediscrete dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+    S = project_batch<Rcpp_projector, TD_SD >(dat, pars, num_threads);
+    break;
+  }
+  case TD_type::PROPER : {
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC : {
+      ext_dat_timediscrete_thresholddistdiscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
+      S = project_batch<Rcpp_projector, TD_proper_loglogistic >(dat, pars, num_threads);
+      break;
+    }
+    case dist_type::LOGNORMAL : {
+      ext_dat_timediscrete_thresholddistdiscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
+      S = project_batch<Rcpp_projector, TD_proper_lognormal >(dat, pars, num_threads);
+      break;
+    }
+    case dist_type::DELTA : {
+      ext_dat_timediscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+      S = project_batch<Rcpp_projector, TD_proper_delta >(dat, pars, num_threads);
+      break;
+    }
+    default : {
+      ext_dat_timediscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+      S = project_batch<Rcpp_projector, TD<random_sample<tpara >, 'P' > >(dat, pars, num_threads, external_sample(z_dist));
+      break;
+    }
+    }
+    break;
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper', 'IT' or 'SD'");
+    break;
+  }
+
+  tobssurv y = gobj["y"];
+  Rcpp::NumericVector LL(S.nrow());
+  tsurv s(S.ncol());
+  for (int i = 0; i < S.nrow(); ++i) {
+    for (int j = 0; j < S.ncol(); ++j) s[j] = S(i, j);
+    LL[i] = calculate_loglikelihood<tsurv, tobssurv >(s, y);
+  }
+  return Rcpp::List::create(Rcpp::Named("S") = S, Rcpp::Named("LL") = LL);
+}
+
+// Projectors on value spans (e.g. of a memory-mapped exposure store), used within threads
+typedef std::vector<double > tstd;
+template<typename TD_mod >
+using span_projector = guts_projector<guts_RED<value_span, value_span, TD_mod, tstd >, value_span, tsurv >;
+template<typename TD_mod >
+using span_fast_projector = guts_projector_fastIT<guts_RED<value_span, value_span, TD_mod, tstd >, value_span, tsurv >;
+
+// Projects all profiles separately (with LPx) in parallel
+struct profile_runner {
+  template<typename tProjector, typename tData, typename tSample >
+  Rcpp::List run(const tData& dat, const tstd& par, const tSample& sample) const {
+    guts_profile_projector<tProjector, tData > proj;
+    proj.set_num_threads(num_threads);
+    proj.initialize(dat, par, sample);
+    Rcpp::NumericMatrix S(profiles.size(), dat.yt_size());
+    Rcpp::NumericMatrix LPx(profiles.size(), x.size());
+    proj.project(profiles, x, &S[0], &LPx[0]);
+    return Rcpp::List::create(Rcpp::Named("S") = S, Rcpp::Named("LPx") = LPx);
+  }
+  const exposure_profiles& profiles;
+  std::vector<double > x;
+  std::size_t num_threads;
+};
+
+// Projects profiles as scenarios with shared prefixes
+struct scenario_runner {
+  template<typename tProjector, typename tData, typename tSample >
+  Rcpp::List run(const tData& dat, const tstd& par, const tSample& sample) const {
+    guts_scenario_projector<tProjector, tData > proj;
+    proj.initialize(dat, par, sample);
+    Rcpp::NumericMatrix S(profiles.size(), dat.yt_size());
+    proj.project(profiles, &S[0]);
+    return Rcpp::List::create(
+      Rcpp::Named("S") = S, 
+      Rcpp::Named("projected_intervals") = static_cast<double >(proj.num_projected_intervals())
+    );
+  }
+  const exposure_profiles& profiles;
+};
+
+// Projects all windows of an exposure profile as separate profiles (with LPx)
+struct window_runner {
+  template<typename tProjector, typename tData, typename tSample >
+  Rcpp::List run(const tData& dat, const tstd& par, const tSample& sample) const {
+    guts_window_projector<tProjector, tData > proj;
+    proj.set_num_threads(num_threads);
+    proj.initialize(dat, par, sample);
+    const std::size_t W = windows.size();
+    Rcpp::NumericVector start(W);
+    for (std::size_t i = 0; i < W; ++i) start[i] = windows.start(i);
+    Rcpp::NumericVector S(W);
+    Rcpp::NumericMatrix LPx(W, x.size());
+    proj.project(windows, x, &S[0], x.size() > 0 ? &LPx[0] : nullptr);
+    return Rcpp::List::create(Rcpp::Named("start") = start, Rcpp::Named("S") = S, Rcpp::Named("LPx") = LPx);
+  }
+  const exposure_windows& windows;
+  std::vector<double > x;
+  std::size_t num_threads;
+};
+
+// Projects exposure profiles with the model of gobj at survival times yt_values 
+// with M grid steps; the runner is called with the projector type, data (yt, M, 
+// N, SVR of gobj and the first profile), parameters and threshold sample
+template<typename tRunner >
+Rcpp::List project_profiles_at(Rcpp::List gobj, Rcpp::NumericVector par, const tstd& yt_values, 
+    SEXP M, const exposure_profiles& profiles, const tRunner& runner, Rcpp::RObject z_dist) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  if (profiles.size() == 0) Rcpp::stop("Need at least one exposure profile.");
+  const value_span yt(yt_values.data(), yt_values.size());
+  profiles.check(yt);
+  const value_span Ct0 = profiles.times(0);
+  const value_span C0 = profiles.concentrations(0);
+  const tpara par_gobj = prepare_parameters(gobj, par);
+  const tstd par_p(par_gobj.begin(), par_gobj.end());
+  const double SVR = gobj["SVR"];
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT : {
+    external_data<value_span, value_span, false, false > dat;
+    dat.set_data_unchecked(Ct0, C0, yt, SVR);
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC :
+      return runner.template run<span_fast_projector<TD_IT_loglogistic > >(dat, par_p, no_external_sample());
+    case dist_type::LOGNORMAL :
+      return runner.template run<span_fast_projector<TD_IT_lognormal > >(dat, par_p, no_external_sample());
+    default :
+      return runner.template run<span_fast_projector<TD<random_sample<tstd >, 'I' > > >(dat, par_p, external_sample(z_dist));
+    }
+  }
+  case TD_type::SD : {
+    external_data<value_span, value_span, true, false > dat;
+    dat.set_data_unchecked(Ct0, C0, yt, Rcpp::as<std::size_t >(M), SVR);
+    return runner.template run<span_projector<TD_SD > >(dat, par_p, no_external_sample());
+  }
+  case TD_type::PROPER : {
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC : {
+      external_data<value_span, value_span, true, true > dat;
+      dat.set_data_unchecked(Ct0, C0, yt, Rcpp::as<std::size_t >(M), gobj["N"], SVR);
+      return runner.template run<span_projector<TD_proper_loglogistic > >(dat, par_p, no_external_sample());
+    }
+    case dist_type::LOGNORMAL : {
+      external_data<value_span, value_span, true, true > dat;
+      dat.set_data_unchecked(Ct0, C0, yt, Rcpp::as<std::size_t >(M), gobj["N"], SVR);
+      return runner.template run<span_projector<TD_proper_lognormal > >(dat, par_p, no_external_sample());
+    }
+    case dist_type::DELTA : {
+      external_data<value_span, value_span, true, false > dat;
+      dat.set_data_unchecked(Ct0, C0, yt, Rcpp::as<std::size_t >(M), SVR);
+      return runner.template run<span_projector<TD_proper_delta > >(dat, par_p, no_external_sample());
+    }
+    default : {
+      external_data<value_span, value_span, true, false > dat;
+      dat.set_data_unchecked(Ct0, C0, yt, Rcpp::as<std::size_t >(M), SVR);
+      return runner.template run<span_projector<TD<random_sample<tstd >, 'P' > > >(dat, par_p, external_sample(z_dist));
+    }
+    }
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper', 'IT' or 'SD'");
+  }
+  return Rcpp::List();
+}
+
+// Projects exposure profiles at the survival times and with the grid of gobj
+template<typename tRunner >
+Rcpp::List project_profiles(Rcpp::List gobj, Rcpp::NumericVector par, 
+    const exposure_profiles& profiles, const tRunner& runner, Rcpp::RObject z_dist) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  return project_profiles_at(gobj, par, Rcpp::as<tstd >(gobj["yt"]), gobj["M"], profiles, runner, z_dist);
+}
+
+// Offsets of ragged profiles; checks that they cover Ct and C
+std::vector<std::uint64_t > profile_offsets(Rcpp::NumericVector Ct, Rcpp::NumericVector C, Rcpp::NumericVector offsets) {
+  if (offsets.size() < 1 || Ct.size() != C.size() || offsets[offsets.size() - 1] != Ct.size() || offsets[0] != 0) {
+    Rcpp::stop("Offsets must start at 0 and end at the number of concentrations.");
+  }
+  return std::vector<std::uint64_t >(offsets.begin(), offsets.end());
+}
+
+// Exposure profiles from R: either a list with Ct, C and offsets (ragged layout) 
+// or the name of an exposure store file, which is memory-mapped
+struct R_exposure_profiles {
+  explicit R_exposure_profiles(Rcpp::RObject source) {
+    if (Rcpp::is<std::string >(source)) {
+      store.reset(new mapped_exposure_store(Rcpp::as<std::string >(source)));
+      prof = store->profiles();
+    } else {
+      Rcpp::List ragged(source);
+      Ct = ragged["Ct"];
+      C = ragged["C"];
+      off = profile_offsets(Ct, C, ragged["offsets"]);
+      prof = exposure_profiles(Ct.size() > 0 ? &Ct[0] : nullptr, C.size() > 0 ? &C[0] : nullptr, off.data(), off.size() - 1);
+    }
+  }
+  inline const exposure_profiles& profiles() const {return prof;}
+  Rcpp::NumericVector Ct;
+  Rcpp::NumericVector C;
+  std::vector<std::uint64_t > off;
+  std::unique_ptr<mapped_exposure_store > store;
+  exposure_profiles prof;
+};
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_profiles( Rcpp::List gobj, Rcpp::NumericVector par, 
+    Rcpp::RObject profiles, Rcpp::NumericVector x, Rcpp::RObject z_dist = R_NilValue) {
+  const R_exposure_profiles prof(profiles);
+  const profile_runner runner = {prof.profiles(), std::vector<double >(x.begin(), x.end()), get_num_threads(gobj)};
+  return project_profiles(gobj, par, prof.profiles(), runner, z_dist);
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_scenarios( Rcpp::List gobj, Rcpp::NumericVector par, 
+    Rcpp::RObject profiles, Rcpp::RObject z_dist = R_NilValue) {
+  const R_exposure_profiles prof(profiles);
+  const scenario_runner runner = {prof.profiles()};
+  return project_profiles(gobj, par, prof.profiles(), runner, z_dist);
+}
+
+// [[Rcpp::export]]
+void guts_write_store( const std::string file, 
+    Rcpp::NumericVector Ct, Rcpp::NumericVector C, Rcpp::NumericVector offsets) {
+  const std::vector<std::uint64_t > off = profile_offsets(Ct, C, offsets);
+  write_exposure_store(file, exposure_profiles(Ct.size() > 0 ? &Ct[0] : nullptr, C.size() > 0 ? &C[0] : nullptr, off.data(), off.size() - 1));
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_read_store( const std::string file) {
+  const mapped_exposure_store store(file);
+  const exposure_profiles& profiles = store.profiles();
+  const std::size_t V = profiles.num_values();
+  return Rcpp::List::create(
+    Rcpp::Named("Ct") = Rcpp::NumericVector(profiles.Ct, profiles.Ct + V), 
+    Rcpp::Named("C") = Rcpp::NumericVector(profiles.C, profiles.C + V), 
+    Rcpp::Named("offsets") = Rcpp::NumericVector(profiles.offsets, profiles.offsets + profiles.size() + 1)
+  );
+}
+
+// Live projection of a GUTS object, to which measurements can be appended
+struct Rcpp_live_base {
+  virtual ~Rcpp_live_base() {}
+  virtual void append(const tstd& Ct, const tstd& C, const tstd& yt, const tstd& y) = 0;
+  virtual Rcpp::List result() const = 0;
+};
+
+// Sets the number of threads and the threshold sample of a live projector
+template<typename tSample >
+struct live_setup {
+  template<typename tModel >
+  void operator()(tModel& model) const {
+    model.set_num_threads(num_threads);
+    sample(model);
+  }
+  const tSample& sample;
+  std::size_t num_threads;
+};
+
+template<typename tProjector, typename tData >
+struct Rcpp_live : public Rcpp_live_base {
+  template<typename tSample >
+  Rcpp_live(const tData& dat, const tstd& y, const tstd& par, const std::size_t num_threads, const tSample& sample) {
+    const live_setup<tSample > setup = {sample, num_threads};
+    live.initialize(dat, y, par, setup);
+  }
+  void append(const tstd& Ct, const tstd& C, const tstd& yt, const tstd& y) override {
+    live.append(Ct, C, yt, y);
+  }
+  Rcpp::List result() const override {
+    const tData& dat = live.data();
+    return Rcpp::List::create(
+      Rcpp::Named("Ct") = Rcpp::wrap(*dat.Ct), 
+      Rcpp::Named("C") = Rcpp::wrap(*dat.C), 
+      Rcpp::Named("yt") = Rcpp::wrap(*dat.yt), 
+      Rcpp::Named("y") = Rcpp::wrap(live.survivors()), 
+      Rcpp::Named("S") = Rcpp::wrap(live.survival()), 
+      Rcpp::Named("LL") = live.loglikelihood()
+    );
+  }
+  guts_live_projector<tProjector, tData > live;
+};
+
+template<typename TD_mod >
+using live_projector = guts_projector<guts_RED<tstd, tstd, TD_mod, tstd >, tstd, tsurv >;
+template<typename TD_mod >
+using live_fast_projector = guts_projector_fastIT<guts_RED<tstd, tstd, TD_mod, tstd >, tstd, tsurv >;
+
+template<typename tProjector, typename tData, typename tSample = no_external_sample >
+Rcpp_live_base* make_live(const tData& dat, const tstd& y, const tstd& par, const std::size_t num_threads, const tSample& sample = tSample()) {
+  return new Rcpp_live<tProjector, tData >(dat, y, par, num_threads, sample);
+}
+
+// Creates the live projection of gobj; always projects on the time grid (SD, Proper) 
+// or at concentration boundaries and damage maxima (IT), also for constant exposure
+Rcpp_live_base* make_live(Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject z_dist) {
+  const tpara par_gobj = prepare_parameters(gobj, par);
+  const tstd par_p(par_gobj.begin(), par_gobj.end());
+  const tstd Ct = Rcpp::as<tstd >(gobj["Ct"]);
+  const tstd C = Rcpp::as<tstd >(gobj["C"]);
+  const tstd yt = Rcpp::as<tstd >(gobj["yt"]);
+  const tstd y = Rcpp::as<tstd >(gobj["y"]);
+  const double SVR = gobj["SVR"];
+  const std::size_t num_threads = get_num_threads(gobj);
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT : {
+    external_data<tstd, tstd, false, false > dat;
+    dat.set_data_unchecked(Ct, C, yt, SVR);
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC :
+      return make_live<live_fast_projector<TD_IT_loglogistic > >(dat, y, par_p, num_threads);
+    case dist_type::LOGNORMAL :
+      return make_live<live_fast_projector<TD_IT_lognormal > >(dat, y, par_p, num_threads);
+    default :
+      return make_live<live_fast_projector<TD<random_sample<tstd >, 'I' > > >(dat, y, par_p, num_threads, external_sample(z_dist));
+    }
+  }
+  case TD_type::SD : {
+    external_data<tstd, tstd, true, false > dat;
+    dat.set_data_unchecked(Ct, C, yt, gobj["M"], SVR);
+    return make_live<live_projector<TD_SD > >(dat, y, par_p, num_threads);
+  }
+  case TD_type::PROPER : {
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC : {
+      external_data<tstd, tstd, true, true > dat;
+      dat.set_data_unchecked(Ct, C, yt, gobj["M"], gobj["N"], SVR);
+      return make_live<live_projector<TD_proper_loglogistic > >(dat, y, par_p, num_threads);
+    }
+    case dist_type::LOGNORMAL : {
+      external_data<tstd, tstd, true, true > dat;
+      dat.set_data_unchecked(Ct, C, yt, gobj["M"], gobj["N"], SVR);
+      return make_live<live_projector<TD_proper_lognormal > >(dat, y, par_p, num_threads);
+    }
+    case dist_type::DELTA : {
+      external_data<tstd, tstd, true, false > dat;
+      dat.set_data_unchecked(Ct, C, yt, gobj["M"], SVR);
+      return make_live<live_projector<TD_proper_delta > >(dat, y, par_p, num_threads);
+    }
+    default : {
+      external_data<tstd, tstd, true, false > dat;
+      dat.set_data_unchecked(Ct, C, yt, gobj["M"], SVR);
+      return make_live<live_projector<TD<random_sample<tstd >, 'P' > > >(dat, y, par_p, num_threads, external_sample(z_dist));
+    }
+    }
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper', 'IT' or 'SD'");
+  }
+  return nullptr;
+}
+
+// [[Rcpp::export]]
+SEXP guts_engine_live_create( Rcpp::List gobj, Rcpp::NumericVector par, Rcpp::RObject z_dist = R_NilValue) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  return Rcpp::XPtr<Rcpp_live_base >(make_live(gobj, par, z_dist), true);
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_live_append( SEXP live, 
+    Rcpp::NumericVector Ct, Rcpp::NumericVector C, Rcpp::NumericVector yt, Rcpp::NumericVector y) {
+  Rcpp::XPtr<Rcpp_live_base > ptr(live);
+  ptr->append(Rcpp::as<tstd >(Ct), Rcpp::as<tstd >(C), Rcpp::as<tstd >(yt), Rcpp::as<tstd >(y));
+  return ptr->result();
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_live_result( SEXP live) {
+  Rcpp::XPtr<Rcpp_live_base > ptr(live);
+  return ptr->result();
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_windows( Rcpp::List gobj, Rcpp::NumericVector par, const double window, 
+    const std::size_t steps_per_window, const std::size_t steps_per_shift, 
+    Rcpp::NumericVector x, Rcpp::RObject z_dist = R_NilValue) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  const tstd Ct = Rcpp::as<tstd >(gobj["Ct"]);
+  const tstd C = Rcpp::as<tstd >(gobj["C"]);
+  const exposure_windows windows(Ct, C, window, steps_per_window, steps_per_shift);
+  window_block first;
+  const exposure_profiles profiles = windows.profiles(0, 1, first);
+  const tstd yt = {0.0, window};
+  const window_runner runner = {windows, std::vector<double >(x.begin(), x.end()), get_num_threads(gobj)};
+  return project_profiles_at(gobj, par, yt, Rcpp::wrap(steps_per_window), profiles, runner, z_dist);
+}
+
+// Log-likelihood of the survivors of gobj, accumulated during the projection, which 
+// stops as soon as the log-likelihood falls below LL_min. Constant exposure is 
+// projected with the closed-form solutions, as in guts_engine().
+template<template<typename > class tProjector, typename TD_mod, typename tData, typename tSample = no_external_sample >
+double fused_loglikelihood(Rcpp::List gobj, const tData& dat, const tpara& par, const double LL_min, const tSample& sample = tSample()) {
+  const tobssurv y = gobj["y"];
+  if (is_constant_exposure(dat)) {
+    Rcpp_constant_exposure_projector<TD_mod > proj;
+    proj.add_data(dat);
+    proj.set_num_threads(get_num_threads(gobj));
+    sample(proj);
+    return calculate_loglikelihood<tsurv, tobssurv >(project(proj, par, proj.run), y);
+  }
+  tProjector<TD_mod > proj;
+  proj.add_data(dat);
+  proj.set_num_threads(get_num_threads(gobj));
+  sample(proj);
+  proj.set_parameters(par);
+  proj.initialize_from_parameters();
+  proj.set_start_conditions(proj.run);
+  return proj.project_loglikelihood(proj.run, y, LL_min);
+}
+
+// [[Rcpp::export]]
+double guts_engine_loglikelihood( Rcpp::List gobj, Rcpp::NumericVector par, const double LL_min, Rcpp::RObject z_dist = R_NilValue) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  const tpara par_p = prepare_parameters(gobj, par);
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT : {
+    ext_dat dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["SVR"]);
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC :
+      return fused_loglikelihood<Rcpp_fast_projector, TD_IT_loglogistic >(gobj, dat, par_p, LL_min);
+    case dist_type::LOGNORMAL :
+      return fused_loglikelihood<Rcpp_fast_projector, TD_IT_lognormal >(gobj, dat, par_p, LL_min);
+    default :
+      return fused_loglikelihood<Rcpp_fast_projector, TD<random_sample<tpara >, 'I' > >(gobj, dat, par_p, LL_min, external_sample(z_dist));
+    }
+  }
+  case TD_type::SD : {
+    ext_dat_timediscrete dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+    return fused_loglikelihood<Rcpp_projector, TD_SD >(gobj, dat, par_p, LL_min);
+  }
+  case TD_type::PROPER : {
+    switch (static_cast<unsigned >(gobj.attr("dist_type"))) {
+    case dist_type::LOGLOGISTIC : {
+      ext_dat_timediscrete_thresholddistdiscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
+      return fused_loglikelihood<Rcpp_projector, TD_proper_loglogistic >(gobj, dat, par_p, LL_min);
+    }
+    case dist_type::LOGNORMAL : {
+      ext_dat_timediscrete_thresholddistdiscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
+      return fused_loglikelihood<Rcpp_projector, TD_proper_lognormal >(gobj, dat, par_p, LL_min);
+    }
+    case dist_type::DELTA : {
+      ext_dat_timediscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+      return fused_loglikelihood<Rcpp_projector, TD_proper_delta >(gobj, dat, par_p, LL_min);
+    }
+    default : {
+      ext_dat_timediscrete dat;
+      dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+      return fused_loglikelihood<Rcpp_projector, TD<random_sample<tpara >, 'P' > >(gobj, dat, par_p, LL_min, external_sample(z_dist));
+    }
+    }
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper', 'IT' or 'SD'");
+  }
+  return NA_REAL;
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_rescore( Rcpp::NumericMatrix S, Rcpp::NumericMatrix y) {
+  if (S.ncol() != y.ncol()) {
+    Rcpp::stop( "Survivors need one column per survival time point." );
+  }
+  const std::size_t R = y.nrow();
+  Rcpp::NumericMatrix LL(S.nrow(), R), SPPE(S.nrow(), R), squares(S.nrow(), R);
+  const tstd y_p(y.begin(), y.end());
+  tstd p(S.ncol()), LL_i(R), SPPE_i(R), squares_i(R);
+  for (int i = 0; i < S.nrow(); ++i) {
+    for (int j = 0; j < S.ncol(); ++j) p[j] = S(i, j);
+    score_survivor_replicates(p, y_p.data(), R, LL_i.data(), SPPE_i.data(), squares_i.data());
+    for (std::size_t r = 0; r < R; ++r) {
+      LL(i, r) = LL_i[r];
+      SPPE(i, r) = SPPE_i[r];
+      squares(i, r) = squares_i[r];
+    }
+  }
+  return Rcpp::List::create(
+    Rcpp::Named("LL") = LL,
+    Rcpp::Named("SPPE") = SPPE,
+    Rcpp::Named("squares") = squares
+  );
+}
+
+// Simulates the survivors of parameter set p (row of par), replicate r in row p * R + r 
+// from stream p * R + r of the seed (see simulate_replicates()).
+template<typename tMortality, typename tThreshold >
+void simulate_parameter_set(const tMortality& mortality, const tThreshold& threshold, 
+    const std::size_t p, const std::size_t n, const std::size_t R, const std::uint64_t seed, 
+    const std::size_t num_threads, Rcpp::IntegerMatrix& y) {
+  simulate_replicates(mortality, threshold, n, R, seed, p * R, num_threads, &y[0], y.nrow(), p * R);
+}
+
+// [[Rcpp::export]]
+Rcpp::IntegerMatrix guts_engine_simulate( Rcpp::List gobj, Rcpp::NumericMatrix par, const int replicates, const int individuals, const double seed, Rcpp::RObject z_dist = R_NilValue) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  tpara par_obj = gobj["par"];
+  if (par.ncol() != par_obj.length()) Rcpp::stop("Wrong number of parameters for model '" + Rcpp::as<std::string >(gobj["model"]) + "'");
+  if (replicates < 1 || individuals < 0) Rcpp::stop("Need at least one replicate and a non-negative number of individuals.");
+  if (!(seed >= 0)) Rcpp::stop("Seed must be a non-negative number.");
+  const std::size_t P = par.nrow();
+  const std::size_t R = replicates;
+  const std::size_t n = individuals;
+  const std::uint64_t s = static_cast<std::uint64_t >(seed);
+  const std::size_t num_threads = get_num_threads(gobj);
+  ttime yt = gobj["yt"];
+  Rcpp::IntegerMatrix y(P * R, yt.size());
+  const unsigned dist = static_cast<unsigned >(gobj.attr("dist_type"));
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT : {
+    ext_dat dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["SVR"]);
+    if (dist != dist_type::LOGLOGISTIC && dist != dist_type::LOGNORMAL && dist != dist_type::EXTERNAL) {
+      Rcpp::stop("model 'IT' needs one of the distributions 'loglogistic', 'lognormal' or 'external'");
+    }
+    std::unique_ptr<sample_threshold > sample;
+    if (dist == dist_type::EXTERNAL) {
+      external_sample ext(z_dist);
+      sample.reset(new sample_threshold(ext.z, ext.W));
+    }
+    for (std::size_t p = 0; p < P; ++p) {
+      tolerance_mortality mortality;
+      mortality.initialize(dat, par(p, 1), par(p, 0));
+      if (dist == dist_type::LOGLOGISTIC) {
+        simulate_parameter_set(mortality, loglogistic_threshold(par(p, 2), par(p, 3)), p, n, R, s, num_threads, y);
+      } else if (dist == dist_type::LOGNORMAL) {
+        simulate_parameter_set(mortality, lognormal_threshold(par(p, 2), par(p, 3)), p, n, R, s, num_threads, y);
+      } else {
+        simulate_parameter_set(mortality, *sample, p, n, R, s, num_threads, y);
+      }
+    }
+    break;
+  }
+  case TD_type::SD : {
+    ext_dat_timediscrete dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+    for (std::size_t p = 0; p < P; ++p) {
+      hazard_mortality mortality;
+      mortality.initialize(dat, par(p, 1), par(p, 2), par(p, 0));
+      simulate_parameter_set(mortality, fixed_threshold(par(p, 3)), p, n, R, s, num_threads, y);
+    }
+    break;
+  }
+  case TD_type::PROPER : {
+    ext_dat_timediscrete dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+    if (dist > dist_type::EXTERNAL) {
+      Rcpp::stop("model 'Proper' needs one of the distributions 'loglogistic', 'lognormal', 'delta' or 'external'");
+    }
+    std::unique_ptr<sample_threshold > sample;
+    if (dist == dist_type::EXTERNAL) {
+      external_sample ext(z_dist);
+      sample.reset(new sample_threshold(ext.z, ext.W, 1 / ext.n));
+    }
+    for (std::size_t p = 0; p < P; ++p) {
+      hazard_mortality mortality;
+      mortality.initialize(dat, par(p, 1), par(p, 2), par(p, 0));
+      switch (dist) {
+      case dist_type::LOGLOGISTIC :
+        simulate_parameter_set(mortality, loglogistic_threshold(par(p, 3), par(p, 4)), p, n, R, s, num_threads, y);
+        break;
+      case dist_type::LOGNORMAL :
+        simulate_parameter_set(mortality, lognormal_threshold(par(p, 3), par(p, 4)), p, n, R, s, num_threads, y);
+        break;
+      case dist_type::DELTA :
+        simulate_parameter_set(mortality, fixed_threshold(par(p, 3)), p, n, R, s, num_threads, y);
+        break;
+      default :
+        simulate_parameter_set(mortality, *sample, p, n, R, s, num_threads, y);
+        break;
+      }
+    }
+    break;
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper', 'IT' or 'SD'");
+  }
+  return y;
+}
+
+// [[Rcpp::export]]
+Rcpp::List guts_engine_sensitivity( Rcpp::List gobj, Rcpp::NumericVector par, const bool loglikelihood, const bool with_Ct, Rcpp::RObject z_dist = R_NilValue) {
+  if (!gobj.inherits("GUTS")) {
+    Rcpp::stop( "No GUTS object. Use `guts_setup()` to create or modify objects." );
+  }
+  tpara par_obj = gobj["par"];
+  if (par.size() != par_obj.length()) Rcpp::stop("Wrong number of parameters for model '" + Rcpp::as<std::string >(gobj["model"]) + "'");
+  const survival_objective objective = loglikelihood ? survival_objective::loglikelihood : survival_objective::final_survival;
+  const tobssurv y = gobj["y"];
+  exposure_sensitivity res;
+  const unsigned dist = static_cast<unsigned >(gobj.attr("dist_type"));
+  switch (static_cast<unsigned >(gobj.attr("TD_type"))) {
+  case TD_type::IT : {
+    ext_dat dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["SVR"]);
+    if (dist == dist_type::LOGLOGISTIC) {
+      loglogistic d;
+      d.set_threshold_alpha(par[2]);
+      d.set_threshold_beta(par[3]);
+      tolerance_exposure_sensitivity(dat, par[1], par[0], d, objective, y, with_Ct, res);
+    } else if (dist == dist_type::LOGNORMAL) {
+      lognormal d;
+      d.set_threshold_mean(par[2]);
+      d.set_threshold_sd(par[3]);
+      tolerance_exposure_sensitivity(dat, par[1], par[0], d, objective, y, with_Ct, res);
+    } else {
+      Rcpp::stop("Derivatives of model 'IT' need one of the continuous distributions 'loglogistic' or 'lognormal'");
+    }
+    break;
+  }
+  case TD_type::SD : {
+    ext_dat_timediscrete dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["SVR"]);
+    hazard_exposure_sensitivity(dat, par[1], par[2], par[0], fixed_hazard_threshold(par[3]), objective, y, with_Ct, res);
+    break;
+  }
+  case TD_type::PROPER : {
+    ext_dat_timediscrete_thresholddistdiscrete dat;
+    dat.set_data_unchecked(gobj["Ct"], gobj["C"], gobj["yt"], gobj["M"], gobj["N"], gobj["SVR"]);
+    hazard_thresholds th;
+    switch (dist) {
+    case dist_type::LOGLOGISTIC : {
+      imp_loglogistic samp;
+      samp.initialize(dat.N);
+      samp.set_threshold_alpha(par[3]);
+      samp.set_threshold_beta(par[4]);
+      samp.calc_sample();
+      th = importance_hazard_thresholds(samp);
+      break;
+    }
+    case dist_type::LOGNORMAL : {
+      imp_lognormal samp;
+      samp.initialize(dat.N);
+      samp.set_threshold_mean(par[3]);
+      samp.set_threshold_sd(par[4]);
+      samp.calc_sample();
+      th = importance_hazard_thresholds(samp);
+      break;
+    }
+    case dist_type::DELTA :
+      th = fixed_hazard_threshold(par[3]);
+      break;
+    case dist_type::EXTERNAL : {
+      external_sample ext(z_dist);
+      th = sample_hazard_thresholds(ext.z, ext.w, ext.n);
+      break;
+    }
+    default :
+      Rcpp::stop("model 'Proper' needs one of the distributions 'loglogistic', 'lognormal', 'delta' or 'external'");
+    }
+    hazard_exposure_sensitivity(dat, par[1], par[2], par[0], th, objective, y, with_Ct, res);
+    break;
+  }
+  default : 
+    Rcpp::stop("model needs to be one of 'Proper', 'IT' or 'SD'");
+  }
+  return Rcpp::List::create(
+    Rcpp::Named("value") = res.value,
+    Rcpp::Named("S") = res.S,
+    Rcpp::Named("dC") = res.dC,
+    Rcpp::Named("dCt") = with_Ct ? Rcpp::RObject(Rcpp::wrap(res.dCt)) : Rcpp::RObject(R_NilValue)
+  );
+}
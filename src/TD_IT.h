@@ -26,72 +26,104 @@
 template< typename sampler >
 class TD_IT_base : public TD_base, public background_mortality {
 public:
+  /**
+   * @brief lowest threshold with $z \geq D$
+   */
+  struct state : public TD_base::state {
+    typename sampler::sample_type::const_iterator zit;
+  };
+  std::unique_ptr<TD_base::state > make_state() const override {
+    return std::unique_ptr<TD_base::state >(new state());
+  }
 	void initialize_from_parameters() override {}
   virtual ~TD_IT_base() {}
-  bool is_still_gathering() const override {return zit != samp.end();}
-  void update_to_next_survival_measurement() const override {
+  bool is_still_gathering(const TD_base::state& s) const override {return static_cast<const state& >(s).zit != samp.end();}
+  void update_to_next_survival_measurement(TD_base::state&) const override {
     // zit not reset, as lowest z above D can only increase over time
   }
     /**
      *\brief gather an effect from known damage
         * \param[in] D damage
         */
-        inline void gather_effect(const double D) const override {
-          zit = std::lower_bound(this->zit, samp.end(), D);
+        inline void gather_effect(TD_base::state& s, const double D) const override {
+          GUTS_COUNT(gather_calls);
+          state& st = static_cast<state& >(s);
+          st.zit = std::lower_bound(st.zit, samp.end(), D);
           // zit points to lowest z >= D
         }
+  void set_start_conditions(TD_base::state& s) const override {
+    static_cast<state& >(s).zit = samp.begin();
+  }
   public:
-  	mutable sampler samp;
-  protected:
-    ///lowest threshold with $z[zpos] \geq D$
-    mutable typename sampler::sample_type::const_iterator zit;
+  	sampler samp;
 };
 
-double sumExp(const double& a, const double& b) {return a + std::exp(b);}
-
 template< typename sampler >
 class TD<sampler, 'I' > : public TD_IT_base<sampler > {
 public:
   TD() : TD_IT_base<sampler >() {}
   virtual ~TD() {}
+  /**
+   * @brief initializes the sampler and the cumulated weights from the upper end of the sample
+   * @details weights depend on the sample size only
+   */
   inline virtual void initialize(const std::size_t sample_size) {
 		this->samp.initialize(sample_size);
     Sj.resize(sample_size);
+  	double S = 0;
+  	for (std::size_t u = sample_size; u > 0; --u) {
+  		S += exp(this->samp.weight_at(u-1));
+  		Sj[u-1] = S;
+  	}
   }
   template<typename tTDdata >
   inline void initialize(const tTDdata& TDdata) {
     initialize(TDdata.N);
   }
-  inline void set_start_conditions() const override {
+  /**
+   * @brief calculates the threshold sample
+   */
+  void initialize_from_parameters() override {
   	this->samp.calc_sample();
-  	this->zit = this->samp.z.begin();
-	  std::vector<double >::reverse_iterator it = Sj.rbegin();
-	  this->zw.back() = exp(this->zw.back());
-	  std::partial_sum(this->zw.rbegin(), this->zw.rend(), it, sumExp);
   }
-  inline double calculate_current_survival(const double yt) const override {
-    return this->zit == this->z.end() ? 0 : Sj.at(this->zit - this->z.begin())  / this->samp.sample_size() * exp( -this->hb * yt );
+  inline double calculate_current_survival(const TD_base::state& s, const double yt) const override {
+    GUTS_PHASE(survival);
+    GUTS_COUNT(survival_calls);
+    GUTS_COUNT(exp_log_calls);
+    const typename TD_IT_base<sampler >::state& st = static_cast<const typename TD_IT_base<sampler >::state& >(s);
+    return st.zit == this->samp.end() ? 0 : Sj.at(st.zit - this->samp.begin())  / this->samp.sample_size() * exp( -this->hb * yt );
   }
 private:
-  mutable std::vector<double > Sj;
+  std::vector<double > Sj;
 };
 
 
 struct TD_IT_CDF :
 		virtual public TD_base,
 		virtual public background_mortality {
+	/**
+	 * @brief maximum of the threshold CDF over the damage gathered so far
+	 */
+	struct state : public TD_base::state {
+		state() : M(0) {}
+		double M;
+	};
 	virtual ~TD_IT_CDF() {}
+	  std::unique_ptr<TD_base::state > make_state() const override {
+	    return std::unique_ptr<TD_base::state >(new state());
+	  }
 	  template<typename tTDdata >
-	  inline void initialize(const tTDdata&) {M=0;}
+	  inline void initialize(const tTDdata&) {}
 	  void initialize_from_parameters() override {}
-	  inline void set_start_conditions() const override {M=0;}
-	  inline bool is_still_gathering() const override {return M<1;}
-	  inline void update_to_next_survival_measurement() const override {};
-	  inline double calculate_current_survival(const double yt) const override {
-	    return (1-M) * std::exp( -this->hb * yt );
+	  inline void set_start_conditions(TD_base::state& s) const override {static_cast<state& >(s).M = 0;}
+	  inline bool is_still_gathering(const TD_base::state& s) const override {return static_cast<const state& >(s).M < 1;}
+	  inline void update_to_next_survival_measurement(TD_base::state&) const override {};
+	  inline double calculate_current_survival(const TD_base::state& s, const double yt) const override {
+	    GUTS_PHASE(survival);
+	    GUTS_COUNT(survival_calls);
+	    GUTS_COUNT(exp_log_calls);
+	    return (1 - static_cast<const state& >(s).M) * std::exp( -this->hb * yt );
 	  }
-protected:
-  mutable double M;
 };
 
 template<>
@@ -100,8 +132,18 @@ public TD_IT_CDF
 {
 public:
   virtual ~TD() {}
-  inline void gather_effect(const double D) const override {
-	M = std::max(M, samp.CDF(D));
+  inline void gather_effect(TD_base::state& s, const double D) const override {
+	GUTS_COUNT(gather_calls);
+	GUTS_COUNT(exp_log_calls);
+	state& st = static_cast<state& >(s);
+	st.M = std::max(st.M, samp.CDF(D));
+  }
+  /**
+   * @returns survival at time yt for constant exposure, with D the (maximum) damage at yt
+   */
+  template<typename tExcess >
+  inline double calculate_constant_exposure_survival(const double D, const tExcess&, const double yt) const {
+	return (1 - samp.CDF(D)) * std::exp( -this->hb * yt );
   }
 	loglogistic samp;
 };
@@ -112,8 +154,18 @@ public TD_IT_CDF
 {
 public:
   virtual ~TD() {}
-  inline void gather_effect(const double D) const override {
-	M = std::max(M, samp.CDF(D));
+  inline void gather_effect(TD_base::state& s, const double D) const override {
+	GUTS_COUNT(gather_calls);
+	GUTS_COUNT(exp_log_calls);
+	state& st = static_cast<state& >(s);
+	st.M = std::max(st.M, samp.CDF(D));
+  }
+  /**
+   * @returns survival at time yt for constant exposure, with D the (maximum) damage at yt
+   */
+  template<typename tExcess >
+  inline double calculate_constant_exposure_survival(const double D, const tExcess&, const double yt) const {
+	return (1 - samp.CDF(D)) * std::exp( -this->hb * yt );
   }
 	lognormal samp;
 };
@@ -121,16 +173,33 @@ public:
 
 template<typename tz >
 struct TD<random_sample<tz >, 'I' >: public TD_IT_base<random_sample<tz > > {
+	typedef typename TD_IT_base<random_sample<tz > >::state state;
 	TD() : TD_IT_base<random_sample<tz > >() {}
 	virtual ~TD() {}
 	template<typename tTDdata > inline void initialize([[gnu::unused]] const tTDdata& TDdata) {}
-	void set_start_conditions() const override {
-		this->zit = this->samp.begin();
-	}
-  inline double calculate_current_survival(const double yt) const override {
-    std::size_t S = this->samp.end() - this->zit;
-    return static_cast<double>(S) * exp( -this->hb * yt ) / 
-    	static_cast<double>(this->samp.sample_size());
+  inline double calculate_current_survival(const TD_base::state& s, const double yt) const override {
+    GUTS_PHASE(survival);
+    GUTS_COUNT(survival_calls);
+    GUTS_COUNT(exp_log_calls);
+    return fraction_at_and_above(static_cast<const state& >(s).zit) * exp( -this->hb * yt );
+  }
+  /**
+   * @returns survival at time yt for constant exposure, with D the (maximum) damage at yt
+   */
+  template<typename tExcess >
+  inline double calculate_constant_exposure_survival(const double D, const tExcess&, const double yt) const {
+    return fraction_at_and_above(std::lower_bound(this->samp.begin(), this->samp.end(), D)) * exp( -this->hb * yt );
+  }
+private:
+  /**
+   * @returns the fraction (or weight) of the sample at and above zit
+   */
+  inline double fraction_at_and_above(const typename tz::const_iterator zit) const {
+    if (this->samp.is_weighted()) {
+      return zit == this->samp.end() ? 0.0 : this->samp.upper_weight_at(zit - this->samp.begin());
+    }
+    std::size_t S = this->samp.end() - zit;
+    return static_cast<double>(S) / static_cast<double>(this->samp.sample_size());
   }
 };
 
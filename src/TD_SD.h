@@ -17,15 +17,25 @@
 template<>
 class TD<double, 'S' > : public TD_base {
 public:
-  TD() : TD_base(), E(), dtau(), kk(), kkXdtau(), hb(), z() {}
+  /**
+   * @brief internally accumulated effect
+   */
+  struct state : public TD_base::state {
+    state() : E(0.0) {}
+    double E;
+  };
+  TD() : TD_base(), dtau(), kk(), kkXdtau(), hb(), z() {}
   virtual ~TD() {}
   template<typename tTDdata >
   inline void initialize(const tTDdata& TDdata) {
 	  dtau = TDdata.calculate_dtau();
   }
+  std::unique_ptr<TD_base::state > make_state() const override {
+    return std::unique_ptr<TD_base::state >(new state());
+  }
   void initialize_from_parameters() override {}
-  inline void set_start_conditions() const override {E = 0.0;}
-  bool is_still_gathering() const override {return true;}
+  inline void set_start_conditions(TD_base::state& s) const override {static_cast<state& >(s).E = 0.0;}
+  bool is_still_gathering(const TD_base::state&) const override {return true;}
   /**
   * @returns true if there are still survivors
   */
@@ -38,25 +48,36 @@ public:
   inline double get_killing_rate() const {return kk;}
   inline double get_background_mortality() const {return hb;}
   inline double get_threshold() const {return z;}
-  inline void update_to_next_survival_measurement() const override {}
+  inline void update_to_next_survival_measurement(TD_base::state&) const override {}
   /**
    *\brief gather an effect from known damage
    * \param[in] D damage
    */
-  inline void gather_effect(const double D) const override {
-    if ( D > z ) E += z - D;
+  inline void gather_effect(TD_base::state& s, const double D) const override {
+    GUTS_COUNT(gather_calls);
+    if ( D > z ) static_cast<state& >(s).E += z - D;
   }
   /**
    * \returns  calculate survival at time yt
    * \param[in] yt survival measurement time
    */
-  inline double calculate_current_survival(const double yt) const override {
-    return std::exp(kkXdtau * E - hb * yt);
+  inline double calculate_current_survival(const TD_base::state& s, const double yt) const override {
+    GUTS_PHASE(survival);
+    GUTS_COUNT(survival_calls);
+    GUTS_COUNT(exp_log_calls);
+    return std::exp(kkXdtau * static_cast<const state& >(s).E - hb * yt);
+  }
+  /**
+   * \returns survival at time yt for constant exposure (closed form)
+   * \param[in] damage_excess callable returning the time integral of damage above a threshold until yt
+   * \param[in] yt survival measurement time
+   */
+  template<typename tExcess >
+  inline double calculate_constant_exposure_survival(const double, const tExcess& damage_excess, const double yt) const {
+    return std::exp(-kk * damage_excess(z) - hb * yt);
   }
   
 protected:
-  ///internally accumulated effect
-  mutable double E;
   ///duration of discretization time step
   double dtau;
   ///killing rate
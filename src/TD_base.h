@@ -11,25 +11,46 @@
 #ifndef TD_BASE_H
 #define TD_BASE_H
 
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include "instrumentation.h"
+
 /**
  * @class abstract TD interface
  * 
  * @brief accumulates damage above the threshold and executes respective mortality
+ * @details A TD model holds parameters (and quantities derived from them, e.g. the threshold sample) only.
+ * Everything that changes during a projection is kept in a state object (see make_state()), 
+ * which is passed to all methods. Thus, one parameterized TD model can be shared by concurrent projections.
  */
 class TD_base {
 public:
+	/**
+	 * @brief mutable state of a TD model during one projection
+	 * @details Each TD model derives its own state type; methods cast the passed state to that type.
+	 */
+	struct state {
+		virtual ~state() {}
+	};
 	virtual ~TD_base() {}
+  /**
+   * @returns a new state object of the type required by the TD model
+   */
+  virtual std::unique_ptr<state > make_state() const = 0;
   /**
    * @brief gather an effect from known damage
+   * @param[in,out] s state
    * @param[in] D damage
    */
-  virtual void gather_effect(const double D) const = 0;
+  virtual void gather_effect(state& s, const double D) const = 0;
   /**
    * @brief calculate survival rate at time yt
+   * @param[in] s state
    * @param[in] yt time
    * @returns the survival probability
    */
-  virtual double calculate_current_survival(const double yt) const = 0;
+  virtual double calculate_current_survival(const state& s, const double yt) const = 0;
   /**
    * @brief simulate the number of survivors from the number of survivors in the previous time step
    * @param[in] y_previous: number of survivors in previous time step
@@ -39,10 +60,15 @@ public:
   /**
    * @returns true if damage has not been gathered for all individuals/threshold values 
    */
-  virtual bool is_still_gathering() const = 0;
-  virtual void update_to_next_survival_measurement() const = 0;
-  virtual void set_start_conditions() const = 0;
+  virtual bool is_still_gathering(const state& s) const = 0;
+  virtual void update_to_next_survival_measurement(state& s) const = 0;
+  virtual void set_start_conditions(state& s) const = 0;
   virtual void initialize_from_parameters() = 0;
+  /**
+   * @brief set the number of threads that may be used within one evaluation
+   * @details ignored by models that do not evaluate in parallel
+   */
+  virtual void set_num_threads(const std::size_t) {}
 };
 
 /**
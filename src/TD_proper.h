@@ -16,6 +16,9 @@
 
 #include <iostream>
 #include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "TD_base.h"
 #include "samplers.h"
@@ -27,14 +30,38 @@
 template< typename sampler >
 class TD_proper_base : public TD_base {
 public:
-	TD_proper_base() : TD_base(), samp(), ee(), ff(), zpos(0),
+	/**
+	 * @brief damage gathered per threshold interval
+	 * @details Suffix sums (over thresholds at and above u) of gathered frequencies, damages and survival terms 
+	 * are kept from the last survival calculation. Bins below n_changed have been modified since and 
+	 * only these suffix sums are updated in the next survival calculation.
+	 */
+	struct state : public TD_base::state {
+		state() : ee(), ff(), zpos(0), Fs(), Es(), Ss(), n_changed(0) {}
+		///brief gathered damage
+		std::vector<double > ee;
+		///brief frequency distribution of damage == threshold
+		std::vector<unsigned > ff;
+		std::size_t zpos;
+		///brief suffix sums of ff, ee and survival terms (size N + 1)
+		mutable std::vector<unsigned > Fs;
+		mutable std::vector<double > Es;
+		mutable std::vector<double > Ss;
+		///brief number of bins (from the lower end) whose suffix sums are outdated
+		mutable std::size_t n_changed;
+	};
+	TD_proper_base() : TD_base(), samp(),
 	kk(std::numeric_limits<double>::quiet_NaN()),
 	dtau(std::numeric_limits<double>::quiet_NaN()),
 	kkXdtau(std::numeric_limits<double>::quiet_NaN()),
-	hb(std::numeric_limits<double>::quiet_NaN())
+	hb(std::numeric_limits<double>::quiet_NaN()),
+	num_threads(1)
 {}
 	virtual ~TD_proper_base() {}
-	bool is_still_gathering() const override {return true;}
+	std::unique_ptr<TD_base::state > make_state() const override {
+		return std::unique_ptr<TD_base::state >(new state());
+	}
+	bool is_still_gathering(const TD_base::state&) const override {return true;}
 	inline void set_killing_rate(const double new_kk) {
 		kkXdtau = new_kk * dtau;
 		kk = new_kk;
@@ -42,16 +69,20 @@ public:
 	inline void set_background_mortality(const double new_hb) {hb = new_hb;}
 	inline double get_killing_rate() const {return kk;}
 	inline double get_background_mortality() const {return hb;}
-	void update_to_next_survival_measurement() const override {}
+	void update_to_next_survival_measurement(TD_base::state&) const override {}
 	/**
 	 * @brief gather an effect from known damage
 	 * @param[in] D damage
 	 */
-	inline void gather_effect(const double D) const override {
+	inline void gather_effect(TD_base::state& s, const double D) const override {
+		GUTS_COUNT(gather_calls);
+		state& st = static_cast<state& >(s);
+		std::size_t& zpos = st.zpos;
 		if ( D > samp.variate_back() ) {
 			// damage higher than the largest value in threshold distribution
-			ee.back() += D;
-			ff.back() ++;
+			st.ee.back() += D;
+			st.ff.back() ++;
+			st.n_changed = st.ee.size();
 			return;
 		}
 		if ( D > samp.variate_at(0) ) {
@@ -63,33 +94,128 @@ public:
 			while ( zpos < (samp.sample_size() - 1) && D > samp.variate_at(zpos) ) {
 				++zpos;
 			}
-			ee.at(zpos-1) += D;
-			ff.at(zpos-1)++;
+			st.ee.at(zpos-1) += D;
+			st.ff.at(zpos-1)++;
+			st.n_changed = std::max(st.n_changed, zpos);
 		}
 	}
 
-	inline void set_start_conditions() const override {
-		std::fill(ee.begin(), ee.end(), 0.0);
-		std::fill(ff.begin(), ff.end(), 0);
-		zpos = samp.sample_size()/2;
+	inline void set_start_conditions(TD_base::state& s) const override {
+		state& st = static_cast<state& >(s);
+		st.ee.assign(samp.sample_size(), 0.0);
+		st.ff.assign(samp.sample_size(), 0);
+		st.zpos = samp.sample_size()/2;
+		st.Fs.assign(samp.sample_size() + 1, 0);
+		st.Es.assign(samp.sample_size() + 1, 0.0);
+		st.Ss.assign(samp.sample_size() + 1, 0.0);
+		st.n_changed = samp.sample_size();
+	}
+	/**
+	 * @brief set the number of threads that share the threshold distribution within one evaluation
+	 */
+	inline void set_num_threads(const std::size_t new_num_threads) override {
+		num_threads = std::max<std::size_t >(1, new_num_threads);
 	}
 protected:
-	void initialize_threshold_distribution(const std::size_t sample_size) {
-		ee.assign(sample_size, 0.0);
-		ff.assign(sample_size, 0);
+	///minimum number of thresholds per thread
+	static const std::size_t min_thresholds_per_thread = 2048;
+	/**
+	 * @returns the number of threads used for a threshold distribution of size N
+	 */
+	inline std::size_t threads_for(const std::size_t N) const {
+		return std::max<std::size_t >(1, std::min(num_threads, N / min_thresholds_per_thread));
+	}
+	/**
+	 * @returns the sum of term(u, F, E) over all thresholds u, with F the frequency and E the damage gathered at and above threshold u
+	 * @details The suffix sums of the state are updated for the outdated bins below st.n_changed only;
+	 * sums above are reused from the previous call. 
+	 * With several threads the outdated bins are split into consecutive partitions.
+	 * Frequencies and damages are first summed per partition, then combined to suffix offsets,
+	 * the terms of all partitions are evaluated in parallel starting from these offsets,
+	 * and finally the offsets of the summed terms are added.
+	 */
+	template<typename tTerm >
+	double sum_over_thresholds(const state& st, const tTerm& term) const {
+		const std::vector<double >& ee = st.ee;
+		const std::vector<unsigned >& ff = st.ff;
+		std::vector<unsigned >& Fs = st.Fs;
+		std::vector<double >& Es = st.Es;
+		std::vector<double >& Ss = st.Ss;
+		const std::size_t n = st.n_changed;
+		const std::size_t T = threads_for(n);
+		GUTS_COUNT_N(exp_log_calls, n);
+		st.n_changed = 0;
+		if (T == 1) {
+			for (std::size_t u = n; u > 0; --u) {
+				Fs[u-1] = Fs[u] + ff[u-1];
+				Es[u-1] = Es[u] + ee[u-1];
+				Ss[u-1] = Ss[u] + term(u-1, Fs[u-1], Es[u-1]);
+			}
+			return Ss[0];
+		}
+		std::vector<double > part_E(T, 0.0);
+		std::vector<unsigned > part_F(T, 0);
+		std::vector<double > part_S(T, 0.0);
+#ifdef _OPENMP
+		#pragma omp parallel for num_threads(T)
+#endif
+		for (int c = 0; c < static_cast<int >(T); ++c) {
+			for (std::size_t u = c * n / T; u < (c + 1) * n / T; ++u) {
+				part_F[c] += ff[u];
+				part_E[c] += ee[u];
+			}
+		}
+		// exclusive suffix sums over partitions
+		double E = Es[n];
+		unsigned F = Fs[n];
+		for (std::size_t c = T; c > 0; --c) {
+			const double E_c = part_E[c-1];
+			const unsigned F_c = part_F[c-1];
+			part_E[c-1] = E;
+			part_F[c-1] = F;
+			E += E_c;
+			F += F_c;
+		}
+#ifdef _OPENMP
+		#pragma omp parallel for num_threads(T)
+#endif
+		for (int c = 0; c < static_cast<int >(T); ++c) {
+			double E_u = part_E[c];
+			unsigned F_u = part_F[c];
+			double S_u = 0;
+			for (std::size_t u = (c + 1) * n / T; u > c * n / T; --u) {
+				F_u += ff[u-1];
+				E_u += ee[u-1];
+				S_u += term(u-1, F_u, E_u);
+				Fs[u-1] = F_u;
+				Es[u-1] = E_u;
+				Ss[u-1] = S_u;
+			}
+			part_S[c] = S_u;
+		}
+		double S = Ss[n];
+		for (std::size_t c = T; c > 0; --c) {
+			const double S_c = part_S[c-1];
+			part_S[c-1] = S;
+			S += S_c;
+		}
+#ifdef _OPENMP
+		#pragma omp parallel for num_threads(T)
+#endif
+		for (int c = 0; c < static_cast<int >(T); ++c) {
+			for (std::size_t u = c * n / T; u < (c + 1) * n / T; ++u) {
+				Ss[u] += part_S[c];
+			}
+		}
+		return Ss[0];
 	}
 	void initialize_time_discretization(const double new_dtau) {
 		dtau = new_dtau;
 	}
 public:
 	///the sampler
-	mutable sampler samp;
+	sampler samp;
 protected:
-	///brief gathered damage
-	mutable std::vector<double > ee;
-	///brief frequency distribution of damage == threshold
-	mutable std::vector<unsigned > ff;
-	mutable std::size_t zpos;
 	///killing rate
 	double kk;
 	///length discrete time step
@@ -98,33 +224,54 @@ protected:
 	double kkXdtau;
 	///background mortality
 	double hb;
+	///number of threads within one evaluation
+	std::size_t num_threads;
 };
 
 template<typename sampler >
 struct TD_proper_impsampling : public TD_proper_base<sampler > {
+	typedef typename TD_proper_base<sampler >::state state;
 	TD_proper_impsampling() : TD_proper_base<sampler >() {}
-	void set_start_conditions() const override {
-		TD_proper_base<sampler >::set_start_conditions();
+	/**
+	 * @brief calculates the threshold sample
+	 */
+	void initialize_from_parameters() override {
 		this -> samp.calc_sample();
 	}
-	double calculate_current_survival(const double yt) const override {
-		double E = 0.0;
-		unsigned F = 0;
+	double calculate_current_survival(const TD_base::state& s, const double yt) const override {
+		GUTS_PHASE(survival);
+		GUTS_COUNT(survival_calls);
+		GUTS_COUNT(exp_log_calls);
+		const sampler& samp = this->samp;
+		const double kkXdtau = this->kkXdtau;
+		double S = this->sum_over_thresholds(static_cast<const state& >(s),
+			[&samp, kkXdtau](const std::size_t u, const unsigned F, const double E) {
+				return F == 0 ? exp(samp.weight_at(u) ) : exp((kkXdtau * (samp.variate_at(u) * F - E)) + samp.weight_at(u) );
+			}
+		);
+		return S * exp( -this->hb * yt ) / static_cast<double>(this->samp.sample_size());
+	}
+	/**
+	 * @returns survival at time yt for constant exposure (closed form)
+	 * @param[in] damage_excess callable returning the time integral of damage above a threshold until yt
+	 * @param[in] yt survival measurement time
+	 */
+	template<typename tExcess >
+	double calculate_constant_exposure_survival(const double, const tExcess& damage_excess, const double yt) const {
 		double S = 0;
 		std::size_t N = this->samp.sample_size();
-		for (std::size_t u = N; u > 0; --u) {
-			F += this->ff.at(u-1);
-			E += this->ee.at(u-1);
-			S += F == 0 ? exp(this->samp.weight_at(u-1) ) : exp((this->kkXdtau * (this->samp.variate_at(u-1) * F - E)) + this->samp.weight_at(u-1) );
+#ifdef _OPENMP
+		#pragma omp parallel for reduction(+:S) num_threads(this->threads_for(N))
+#endif
+		for (int u = 0; u < static_cast<int >(N); ++u) {
+			S += exp(-this->kk * damage_excess(this->samp.variate_at(u)) + this->samp.weight_at(u));
 		}
-		return S * exp( -this->hb * yt ) / static_cast<double>(this->samp.sample_size());
+		return S * exp( -this->hb * yt ) / static_cast<double>(N);
 	}
 	virtual ~TD_proper_impsampling() {}
 protected:
-	void initialize_from_parameters() override {}
 	inline void initialize(const double new_dtau, const std::size_t sample_size) {
 		this -> samp.initialize(sample_size);
-		TD_proper_impsampling<sampler >::initialize_threshold_distribution(sample_size);
 		TD_proper_impsampling<sampler >::initialize_time_discretization(new_dtau);
 	}
 };
@@ -136,7 +283,6 @@ public:
 	template<typename tTDdata >
 	inline void initialize(const tTDdata& TDdata) {
 		this->samp.initialize(TDdata.N);
-		this->initialize_threshold_distribution(TDdata.N);
 		this->initialize_time_discretization(TDdata.calculate_dtau());
 	}
 	virtual ~TD() {}
@@ -148,7 +294,6 @@ struct TD<imp_delta, 'P' > : public TD_proper_impsampling<imp_delta > {
 	template<typename tTDdata >
 	inline void initialize(const tTDdata& TDdata) {
 		this->samp.initialize();
-		this->initialize_threshold_distribution(1);
 		this->initialize_time_discretization(TDdata.calculate_dtau());
 	}
 	inline void set_threshold(const double new_z) {samp.set_threshold(new_z);}
@@ -159,26 +304,60 @@ struct TD<imp_delta, 'P' > : public TD_proper_impsampling<imp_delta > {
 template<typename tz >
 class TD<random_sample<tz >, 'P' >: public TD_proper_base<random_sample<tz > > {
 public:
+	typedef typename TD_proper_base<random_sample<tz > >::state state;
 	TD() : TD_proper_base<random_sample<tz > >() {  }
 	template<typename tTDdata >
 	inline void initialize(const tTDdata& TDdata) {
 		TD_proper_base<random_sample<tz > >::initialize_time_discretization(TDdata.calculate_dtau());
 	}
-	void initialize_from_parameters() override {
-		TD_proper_base<random_sample<tz > >::initialize_threshold_distribution(
-				this->samp.sample_size()
+	void initialize_from_parameters() override {}
+	virtual ~TD() {}
+	inline double calculate_current_survival(const TD_base::state& s, const double yt) const override {
+		GUTS_PHASE(survival);
+		GUTS_COUNT(survival_calls);
+		GUTS_COUNT(exp_log_calls);
+		const random_sample<tz >& samp = this->samp;
+		const double kkXdtau = this->kkXdtau;
+		if (samp.is_weighted()) {
+			// as in the unweighted sum below, a threshold at infinity has the weight 1/n of one variate of the raw sample
+			double S = 1 / samp.raw_sample_size() + this->sum_over_thresholds(static_cast<const state& >(s),
+				[&samp, kkXdtau](const std::size_t u, const unsigned F, const double E) {
+					return samp.weight_at(u) * exp(   (kkXdtau * (samp.variate_at(u) * F - E)) );
+				}
+			);
+			return S * exp( -this->hb * yt );
+		}
+		double S = 1 + this->sum_over_thresholds(static_cast<const state& >(s),
+			[&samp, kkXdtau](const std::size_t u, const unsigned F, const double E) {
+				return exp(   (kkXdtau * (samp.variate_at(u) * F - E)) );
+			}
 		);
+		return S * exp( -this->hb * yt ) / static_cast<double>(this->samp.sample_size());
 	}
-	virtual ~TD() {}
-	inline double calculate_current_survival(const double yt) const override {
-		double E = 0.0;
-		unsigned F = 0;
-		double S = 1;
+	/**
+	 * @returns survival at time yt for constant exposure (closed form)
+	 * @param[in] damage_excess callable returning the time integral of damage above a threshold until yt
+	 * @param[in] yt survival measurement time
+	 */
+	template<typename tExcess >
+	double calculate_constant_exposure_survival(const double, const tExcess& damage_excess, const double yt) const {
 		std::size_t N = this->samp.sample_size();
-		for (std::size_t u = N; u > 0; --u) {
-			E += this->ee.at(u - 1);
-			F += this->ff.at(u - 1);
-			S += exp(   (this->kkXdtau * (this->samp.variate_at(u - 1) * F - E)) );
+		if (this->samp.is_weighted()) {
+			double S = 1 / this->samp.raw_sample_size();
+#ifdef _OPENMP
+			#pragma omp parallel for reduction(+:S) num_threads(this->threads_for(N))
+#endif
+			for (int u = 0; u < static_cast<int >(N); ++u) {
+				S += this->samp.weight_at(u) * exp(-this->kk * damage_excess(this->samp.variate_at(u)));
+			}
+			return S * exp( -this->hb * yt );
+		}
+		double S = 1;
+#ifdef _OPENMP
+		#pragma omp parallel for reduction(+:S) num_threads(this->threads_for(N))
+#endif
+		for (int u = 0; u < static_cast<int >(N); ++u) {
+			S += exp(-this->kk * damage_excess(this->samp.variate_at(u)));
 		}
 		return S * exp( -this->hb * yt ) / static_cast<double>(N);
 	}
@@ -50,30 +50,52 @@ public:
 	 *
 	 * @details Solves the differential TK equation (e.g. eq. 1) in Albert et al. (2016).
 	 * External concentration $C(t)$ is linearly interpolated between measurement time steps $Ct$.
+	 * @param[in,out] s damage state, updated to the damage at time t
 	 * @param[in] t time at which to calculate the damage
 	 * @param[in] k index of concentration measurement interval. The index defines the boundary (starting) conditions and must point to the concentration measurement interval in which t lies (i.e. Ct[k] <= t < Ct[k+1])
 	 */
-	inline double calculate_damage(const std::size_t k, const double t) const override {
+	inline double calculate_damage(TK_state& s, const std::size_t k, const double t) const override {
+		GUTS_COUNT(damage_calls);
+		GUTS_COUNT(exp_log_calls);
 		double tmp = exp( -ke_times_SVR * (t - this->Ct->at(k)) );
 		double summand3 =
 			ke_times_SVR > 0.0  ? (t - this->Ct->at(k) - (1.0-tmp)/ke_times_SVR)  *  this->diffCCt[k] : 0.0;
-		this -> D = tmp * (this->D_k - this->C->at(k)) + this->C->at(k) + summand3;
-		return this -> D;
+		s.D = tmp * (s.D_k - this->C->at(k)) + this->C->at(k) + summand3;
+		return s.D;
+	}
+	/**
+	 * @brief Damage at a point of the time grid of guts_projector
+	 *
+	 * @details Calculates the damage at grid time $tau$ in concentration interval $k$. If the next grid time
+	 * $tau_next$ lies beyond the interval, $k$ moves to the next interval, which starts with the damage at $tau$.
+	 * @param[in,out] s damage state
+	 * @param[in,out] k index of the concentration measurement interval of tau, updated to the interval of tau_next
+	 * @param[in] tau grid time
+	 * @param[in] tau_next next grid time
+	 */
+	inline double calculate_grid_damage(TK_state& s, std::size_t& k, const double tau, const double tau_next) const {
+		const double D = TK_RED::calculate_damage(s, k, tau);
+		if (tau_next > this->Ct->at(k+1)) {
+			++k;
+			parent::update_to_next_concentration_measurement(s);
+		}
+		return D;
 	}
 	/**
 	 * @returns the time $te$ at which the damage assumes an extreme value
 	 *
 	 * @details solution of the first derivative of damage is 0 ($\frac{dD}{dt} = 0$).
+	 * @param[in] s damage state at the beginning of the interval
 	 * @param[in] k index of concentration measurement interval (points to the beginning of the interval).
 	 */
-	inline double calculate_time_of_extreme_damage(const std::size_t k) const {
-		return log((this->D_k - this->C->at(k))*ke_times_SVR/this->diffCCt.at(k) + 1) / ke_times_SVR + this->Ct->at(k);
+	inline double calculate_time_of_extreme_damage(const TK_state& s, const std::size_t k) const {
+		return log((s.D_k - this->C->at(k))*ke_times_SVR/this->diffCCt.at(k) + 1) / ke_times_SVR + this->Ct->at(k);
 	}
 	/**
 	 * @returns the extreme value of the damage
 	 *
 	 * @details  Damage at time $te$
-	 * @param[in] te time at which the damage assumes an extreme value (as calculated in calculate_time_of_extreme_damage(const std::size_t))
+	 * @param[in] te time at which the damage assumes an extreme value (as calculated in calculate_time_of_extreme_damage(const TK_state&, const std::size_t))
 	 * @param[in] k index of concentration measurement interval (points to the beginning of the interval)
 	 */
 	inline double calculate_extreme_damage(const double te, const std::size_t k) const {
@@ -82,11 +104,40 @@ public:
 	/**
 	 * @returns true if an extreme value at $te$ is a maximum
 	 *
-	 * @details evaluates if the second derivative of damage at $te$ (as calculated in calculate_time_of_extreme_damage(const std::size_t)) is below or equal 0 ($\frac{d^{2}D}{dt^{2}} \leq 0$). Equal is admitted to ensure that the extreme value is evaluated in case of doubt.
+	 * @details evaluates if the second derivative of damage at $te$ (as calculated in calculate_time_of_extreme_damage(const TK_state&, const std::size_t)) is below or equal 0 ($\frac{d^{2}D}{dt^{2}} \leq 0$). Equal is admitted to ensure that the extreme value is evaluated in case of doubt.
+	 * @param[in] s damage state at the beginning of the interval
 	 * @param[in] k index of concentration measurement interval (points to the beginning of the interval).
 	 */
-	inline bool is_maximum_damage(const std::size_t k) const {
-		return this->D_k < this->Ct->at(k) - this->diffCCt.at(k) / ke_times_SVR;
+	inline bool is_maximum_damage(const TK_state& s, const std::size_t k) const {
+		return s.D_k < this->C->at(k) - this->diffCCt.at(k) / ke_times_SVR;
+	}
+	/**
+	 * @returns the damage at time $t$ for constant exposure
+	 *
+	 * @details Closed-form solution of the TK equation for constant concentration $C$ and zero initial damage:
+	 * $D(t) = C (1 - e^{-ke \cdot SVR \cdot t})$. Only valid if is_constant_exposure().
+	 * @param[in] t time at which to calculate the damage
+	 */
+	inline double calculate_constant_exposure_damage(const double t) const {
+		return this->C->at(0) * (1.0 - exp(-ke_times_SVR * t));
+	}
+	/**
+	 * @returns the time integral of the damage above threshold $z$ for constant exposure
+	 *
+	 * @details Closed-form solution of $\int_0^t \max(D(s) - z, 0) ds$ with $D(s)$ as in calculate_constant_exposure_damage(const double).
+	 * Damage exceeds $z$ from time $t_z = -\ln(1 - z/C) / (ke \cdot SVR)$ onwards.
+	 * Only valid if is_constant_exposure().
+	 * @param[in] z threshold
+	 * @param[in] t upper integration limit
+	 */
+	inline double calculate_constant_exposure_damage_excess(const double z, const double t) const {
+		const double c = this->C->at(0);
+		if ( z >= c || ke_times_SVR <= 0.0 ) return 0.0;
+		// exp(-ke * SVR * t_z)
+		const double tmp_z = z > 0.0 ? 1.0 - z / c : 1.0;
+		const double tz = -log(tmp_z) / ke_times_SVR;
+		if ( t <= tz ) return 0.0;
+		return (c - z) * (t - tz) - c * (tmp_z - exp(-ke_times_SVR * t)) / ke_times_SVR;
 	}
 protected:
 	double ke;
@@ -13,14 +13,28 @@
 
 #include <cstddef>
 #include <vector>
+#include "instrumentation.h"
 
 //#include "external_data.hpp"
 
+/**
+ * @brief mutable state of a TK model during one projection
+ * @details The TK model itself holds data and parameters only and is not changed by a projection. 
+ * Each projection keeps the damage in its own state object, i.e. several projections of the same model can run concurrently.
+ */
+struct TK_state {
+  TK_state() : D(0), D_k(0) {}
+  ///brief current damage
+  double D;
+  ///brief damage at last concentration measurement time step
+  double D_k;
+};
+
 /**
  * @class abstract TK interface
  * 
  * @brief Solver for the TK differential equation to calculate the damage
- * @details The method double calculate_current_D() solves the TK equation at the next discretization step and returns the damage.
+ * @details The method double calculate_damage(TK_state&, const std::size_t, const double) solves the TK equation at the next discretization step and returns the damage.
  * The function is called within a while-loop that iterates until bool is_timestep_in_range(const double) fails.
  * The discretization iterator is automatically updated.
  */
@@ -28,10 +42,10 @@ struct TK {
   TK() {}
   virtual ~TK() {}
   virtual double calculate_damage(
-      const std::size_t k, const double tau) const = 0;
-  virtual void set_start_conditions() const = 0;
+      TK_state& s, const std::size_t k, const double tau) const = 0;
+  virtual void set_start_conditions(TK_state& s) const = 0;
   virtual void initialize_from_parameters() = 0; 
 protected:
-  virtual void update_to_next_concentration_measurement() const = 0;
+  virtual void update_to_next_concentration_measurement(TK_state& s) const = 0;
 };
 #endif //TK_BASE_H
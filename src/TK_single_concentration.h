@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <vector>
+#include <algorithm>
 
 
 #include "TK_base.h"
@@ -34,13 +35,32 @@ public:
   	  initialize(TDdata.Ct, TDdata.C);
     }
   void initialize_from_parameters() override {}
-  void set_start_conditions() const override {
-	  D = 0;
-	  D_k = 0;
+  void set_start_conditions(TK_state& s) const override {
+	  s.D = 0;
+	  s.D_k = 0;
   }
   virtual ~TK_single_concentration() {}
+  /**
+   * @returns true if the concentration does not change over the whole exposure period
+   */
+  inline bool is_constant_exposure() const {return constant_exposure;}
+  /**
+   * @brief updates the differential of C after values were appended to Ct and C
+   * 
+   * @details Only the appended intervals are differentiated, i.e. the cost does not 
+   * depend on the length of the earlier exposure.
+   */
+  void extend_exposure() {
+    const std::size_t n_old = diffCCt.size();
+    diffCCt.resize(Ct->size()-1);
+    for ( std::size_t i = n_old + 1; i < Ct->size(); ++i ) {
+      diffCCt.at(i-1) = (C->at(i) - C->at(i-1)) /
+        (Ct->at(i) - Ct->at(i-1));
+      constant_exposure = constant_exposure && diffCCt.at(i-1) == 0.0;
+    }
+  }
 protected:
-  inline void update_to_next_concentration_measurement() const override {D_k = D;}
+  inline void update_to_next_concentration_measurement(TK_state& s) const override {s.D_k = s.D;}
 	void initialize(
 			const std::shared_ptr<const tCt > new_Ct,
 			const std::shared_ptr<const tC > new_C
@@ -49,6 +69,9 @@ protected:
 		C = new_C;
 		diffCCt.resize(new_Ct->size()-1);
 		differentiateC();
+		constant_exposure = std::all_of(
+			diffCCt.begin(), diffCCt.end(), [](const double d) {return d == 0.0;}
+		);
 	}
   ///brief time steps of concentration measurements
   std::shared_ptr<const tCt > Ct;
@@ -56,10 +79,8 @@ protected:
   std::shared_ptr<const tC > C;
   ///brief differential of concentrations C at measurement times Ct
   std::vector<double > diffCCt;
-  ///brief current damage
-  mutable double D;
-  ///brief damage at last concentration measurement time step
-  mutable double D_k;
+  ///brief true if all concentrations C are equal
+  bool constant_exposure;
 private:
   /**
    * @brief Differentiate the external concentration C
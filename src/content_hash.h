@@ -0,0 +1,52 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+/**
+ * \brief 64-bit FNV-1a hash of a sequence of values
+ * \details Numbers are hashed by value: 0.0 and -0.0 give the same hash, and so do
+ * all NaN. Equal hashes do not imply equal content; compare the values to be sure.
+ */
+class content_hash {
+public:
+  content_hash() : h(14695981039346656037ULL) {}
+  inline void add(const double value) {
+    double v = value == 0.0 ? 0.0 : value;
+    if (std::isnan(v)) v = std::numeric_limits<double >::quiet_NaN();
+    add_bytes(&v, sizeof(v));
+  }
+  inline void add(const std::uint64_t value) {add_bytes(&value, sizeof(value));}
+  /// adds the length of the range and its values
+  template<typename tIterator >
+  void add(tIterator first, const tIterator last) {
+    std::uint64_t n = 0;
+    for (tIterator it = first; it != last; ++it) ++n;
+    add(n);
+    for (; first != last; ++first) add(static_cast<double >(*first));
+  }
+  inline std::uint64_t value() const {return h;}
+private:
+  void add_bytes(const void* data, const std::size_t size) {
+    unsigned char bytes[sizeof(std::uint64_t)];
+    std::memcpy(bytes, data, size);
+    for (std::size_t i = 0; i < size; ++i) {
+      h ^= bytes[i];
+      h *= 1099511628211ULL;
+    }
+  }
+  std::uint64_t h;
+};
+
+#endif //CONTENT_HASH_H
@@ -0,0 +1,103 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-18
+ */
+
+#ifndef EXPOSURE_PROFILES_H
+#define EXPOSURE_PROFILES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "helpers.h"
+#include "external_data_def_and_checks.h"
+
+/**
+ * \brief read-only view of contiguous values (e.g. one exposure profile)
+ * \details Can be used as time and concentration type of external_data and the 
+ * projectors, which then refer to the values without copying them.
+ */
+struct value_span {
+  typedef double value_type;
+  typedef const double* const_iterator;
+  value_span() : first(nullptr), n(0) {}
+  value_span(const double* new_first, const std::size_t new_n) : first(new_first), n(new_n) {}
+  inline const_iterator begin() const {return first;}
+  inline const_iterator end() const {return first + n;}
+  inline std::size_t size() const {return n;}
+  inline double operator[](const std::size_t i) const {return first[i];}
+  inline double at(const std::size_t i) const {
+    if (i >= n) throw std::out_of_range("value_span: index out of range");
+    return first[i];
+  }
+  const double* first;
+  std::size_t n;
+};
+
+inline double back(const value_span& vec) {return vec.at(vec.size()-1);}
+inline double front(const value_span& vec) {return vec.at(0);}
+
+/**
+ * \brief many exposure profiles in a ragged layout
+ * \details Times and concentrations of all profiles are concatenated. Profile i
+ * covers positions offsets[i] to offsets[i+1] - 1. Neither values nor offsets are 
+ * copied; they must outlive the object.
+ */
+struct exposure_profiles {
+  exposure_profiles() : Ct(nullptr), C(nullptr), offsets(nullptr), num_profiles(0) {}
+  /**
+   * \param[in] new_Ct concatenated concentration time points
+   * \param[in] new_C concatenated concentrations
+   * \param[in] new_offsets num_profiles + 1 positions of the profiles, starting with 0
+   * \param[in] new_num_profiles number of profiles
+   */
+  exposure_profiles(const double* new_Ct, const double* new_C, const std::uint64_t* new_offsets, const std::size_t new_num_profiles) :
+    Ct(new_Ct), C(new_C), offsets(new_offsets), num_profiles(new_num_profiles) {}
+  inline std::size_t size() const {return num_profiles;}
+  /// total number of concentration measurements
+  inline std::size_t num_values() const {return num_profiles > 0 ? static_cast<std::size_t >(offsets[num_profiles]) : 0;}
+  inline value_span times(const std::size_t i) const {return value_span(Ct + offsets[i], offsets[i+1] - offsets[i]);}
+  inline value_span concentrations(const std::size_t i) const {return value_span(C + offsets[i], offsets[i+1] - offsets[i]);}
+  /**
+   * \brief throws std::invalid_argument if offsets are not ascending from 0
+   */
+  void check_offsets() const {
+    if (num_profiles > 0 && offsets[0] != 0) throw_invalid_argument("Exposure profiles", "offsets must start with 0.");
+    for (std::size_t i = 1; i <= num_profiles; ++i) {
+      if (offsets[i] < offsets[i-1]) throw_invalid_argument("Exposure profiles", "offsets must be ascending.");
+    }
+  }
+  /**
+   * \brief throws std::invalid_argument if a profile is no valid exposure time series
+   */
+  void check() const {
+    check_offsets();
+    for (std::size_t i = 0; i < size(); ++i) {
+      throw_invalid_argument_if_not_time_series(times(i), concentrations(i), lable(i));
+    }
+  }
+  /**
+   * \brief throws std::invalid_argument if a profile is no valid exposure time series or ends before the survival times
+   */
+  template<typename tt >
+  void check(const tt& yt) const {
+    check();
+    for (std::size_t i = 0; i < size(); ++i) {
+      if (back(yt) > back(times(i))) {
+        throw_invalid_argument(lable(i), "Exposure must not end earlier than the survival times.");
+      }
+    }
+  }
+  const double* Ct;
+  const double* C;
+  const std::uint64_t* offsets;
+  std::size_t num_profiles;
+private:
+  static std::string lable(const std::size_t i) {return std::string("Exposure profile ") + std::to_string(i + 1);}
+};
+
+#endif //EXPOSURE_PROFILES_H
@@ -0,0 +1,191 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-18
+ */
+
+#ifndef EXPOSURE_STORE_H
+#define EXPOSURE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "exposure_profiles.h"
+
+/**
+ * \brief columnar binary file of exposure profiles
+ * \details Layout (native byte order, all fields 8-byte aligned):
+ *   - header of 32 bytes: magic "GUTSEXPO", version (uint32), byte order mark
+ *     0x01020304 (uint32), number of profiles P (uint64), number of values V (uint64)
+ *   - P + 1 offsets (uint64), as in exposure_profiles
+ *   - V concentration time points (double) of all profiles
+ *   - V concentrations (double) of all profiles
+ */
+namespace exposure_store {
+  const char magic[8] = {'G', 'U', 'T', 'S', 'E', 'X', 'P', 'O'};
+  const std::uint32_t version = 1;
+  const std::uint32_t byte_order_mark = 0x01020304;
+  const std::size_t header_size = 32;
+  inline std::size_t file_size(const std::uint64_t num_profiles, const std::uint64_t num_values) {
+    return header_size + 8 * (num_profiles + 1) + 16 * num_values;
+  }
+}
+
+/**
+ * \brief writes exposure profiles to a file in the exposure_store layout
+ * \details Profiles are checked with exposure_profiles::check() before writing.
+ * \throws std::invalid_argument for invalid profiles, std::runtime_error if the file cannot be written
+ */
+inline void write_exposure_store(const std::string& path, const exposure_profiles& profiles) {
+  profiles.check();
+  const std::uint64_t P = profiles.size();
+  const std::uint64_t V = profiles.num_values();
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("Cannot open exposure store '" + path + "' for writing.");
+  out.write(exposure_store::magic, sizeof(exposure_store::magic));
+  out.write(reinterpret_cast<const char* >(&exposure_store::version), sizeof(std::uint32_t));
+  out.write(reinterpret_cast<const char* >(&exposure_store::byte_order_mark), sizeof(std::uint32_t));
+  out.write(reinterpret_cast<const char* >(&P), sizeof(std::uint64_t));
+  out.write(reinterpret_cast<const char* >(&V), sizeof(std::uint64_t));
+  if (P > 0) {
+    out.write(reinterpret_cast<const char* >(profiles.offsets), static_cast<std::streamsize >(8 * (P + 1)));
+  } else {
+    const std::uint64_t zero = 0;
+    out.write(reinterpret_cast<const char* >(&zero), sizeof(std::uint64_t));
+  }
+  out.write(reinterpret_cast<const char* >(profiles.Ct), static_cast<std::streamsize >(8 * V));
+  out.write(reinterpret_cast<const char* >(profiles.C), static_cast<std::streamsize >(8 * V));
+  out.close();
+  if (!out) throw std::runtime_error("Cannot write exposure store '" + path + "'.");
+}
+
+/**
+ * \brief read-only memory map of an exposure store file
+ * \details Opening maps the file and checks the header and the file size only,
+ * i.e. time and memory do not depend on the number of profiles. Pages are read
+ * by the operating system when profiles are accessed. The profiles refer to the
+ * mapped memory and are valid as long as the object exists.
+ */
+class mapped_exposure_store {
+public:
+  /**
+   * \throws std::runtime_error if the file cannot be mapped or is no exposure store
+   */
+  explicit mapped_exposure_store(const std::string& path) : addr(nullptr), length(0), prof() {
+    map(path);
+    try {
+      read_header(path);
+    } catch (...) {
+      unmap();
+      throw;
+    }
+  }
+  ~mapped_exposure_store() {unmap();}
+  mapped_exposure_store(const mapped_exposure_store&) = delete;
+  mapped_exposure_store& operator=(const mapped_exposure_store&) = delete;
+  inline const exposure_profiles& profiles() const {return prof;}
+private:
+  void read_header(const std::string& path) {
+    const char* base = static_cast<const char* >(addr);
+    std::uint32_t file_version, bom;
+    std::uint64_t P, V;
+    if (length < exposure_store::header_size + 8 || std::memcmp(base, exposure_store::magic, sizeof(exposure_store::magic)) != 0) {
+      throw std::runtime_error("'" + path + "' is no exposure store.");
+    }
+    std::memcpy(&file_version, base + 8, sizeof(std::uint32_t));
+    std::memcpy(&bom, base + 12, sizeof(std::uint32_t));
+    std::memcpy(&P, base + 16, sizeof(std::uint64_t));
+    std::memcpy(&V, base + 24, sizeof(std::uint64_t));
+    if (file_version != exposure_store::version) {
+      throw std::runtime_error("Exposure store '" + path + "' has unsupported version " + std::to_string(file_version) + ".");
+    }
+    if (bom != exposure_store::byte_order_mark) {
+      throw std::runtime_error("Exposure store '" + path + "' was written with a different byte order.");
+    }
+    // bound P and V by the file length before their sizes are calculated, which could overflow
+    if (P > length / 8 || V > length / 16 || length != exposure_store::file_size(P, V)) {
+      throw std::runtime_error("Exposure store '" + path + "' is truncated or corrupt.");
+    }
+    const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t* >(base + exposure_store::header_size);
+    const double* Ct = reinterpret_cast<const double* >(base + exposure_store::header_size + 8 * (P + 1));
+    prof = exposure_profiles(Ct, Ct + V, offsets, static_cast<std::size_t >(P));
+    if (offsets[P] != V) throw std::runtime_error("Exposure store '" + path + "' has inconsistent offsets.");
+  }
+#ifdef _WIN32
+  void map(const std::string& path) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open exposure store '" + path + "'.");
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+      CloseHandle(file);
+      throw std::runtime_error("Cannot map exposure store '" + path + "'.");
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+      CloseHandle(file);
+      throw std::runtime_error("Cannot map exposure store '" + path + "'.");
+    }
+    addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (addr == NULL) {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      throw std::runtime_error("Cannot map exposure store '" + path + "'.");
+    }
+    length = static_cast<std::size_t >(size.QuadPart);
+  }
+  void unmap() {
+    if (addr == nullptr) return;
+    UnmapViewOfFile(addr);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    addr = nullptr;
+  }
+  HANDLE file;
+  HANDLE mapping;
+#else
+  void map(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open exposure store '" + path + "'.");
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      throw std::runtime_error("Cannot map exposure store '" + path + "'.");
+    }
+    length = static_cast<std::size_t >(st.st_size);
+    void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("Cannot map exposure store '" + path + "'.");
+    addr = p;
+  }
+  void unmap() {
+    if (addr == nullptr) return;
+    munmap(addr, length);
+    addr = nullptr;
+  }
+#endif
+  void* addr;
+  std::size_t length;
+  exposure_profiles prof;
+};
+
+#endif //EXPOSURE_STORE_H
@@ -14,6 +14,7 @@
 #include<cmath>
 #include<string>
 #include<exception>
+#include<stdexcept>
 #include "helpers.h"
 
 struct num_discretization_time_steps {
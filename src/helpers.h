@@ -3,18 +3,28 @@
  * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
  * License GPL-2
  * 2021-11-30 
+ * updated: 2026-10-19
  */
 
 #ifndef HELPERS_H
 #define HELPERS_H
 
-#include <Rcpp.h>
+#include <stdexcept>
+#include <type_traits>
 
-inline int back(const Rcpp::IntegerVector& vec) {return vec.at(vec.size()-1);}
-inline int front(const Rcpp::IntegerVector& vec) {return vec.at(0);}
-inline double back(const Rcpp::NumericVector& vec) {return vec.at(vec.size()-1);}
-inline double front(const Rcpp::NumericVector& vec) {return vec.at(0);}
-inline double back(const std::vector<double >& vec) {return vec.back();}
-inline double front(const std::vector<double >& vec) {return vec.front();}
+/**
+ * First and last element of any random-access container with size() (std::vector,
+ * std::span, Rcpp vectors). Throws std::out_of_range for empty containers.
+ */
+template<typename tVector >
+inline auto back(const tVector& vec) -> typename std::decay<decltype(vec[0])>::type {
+  if (vec.size() == 0) throw std::out_of_range("back() of an empty container");
+  return vec[vec.size()-1];
+}
+template<typename tVector >
+inline auto front(const tVector& vec) -> typename std::decay<decltype(vec[0])>::type {
+  if (vec.size() == 0) throw std::out_of_range("front() of an empty container");
+  return vec[0];
+}
 
 #endif
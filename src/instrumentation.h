@@ -0,0 +1,152 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * soeren.vogel@posteo.ch, carlo.albert@eawag.ch, alexander singer@rifcon.de, oliver.jakoby@rifcon.de, dirk.nickisch@rifcon.de
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#ifndef GUTS_INSTRUMENTATION_H
+#define GUTS_INSTRUMENTATION_H
+
+/**
+ * Counters of hot-path calls and timers of phases, compiled in with
+ * -DGUTS_INSTRUMENTATION only. Without it, GUTS_COUNT(), GUTS_COUNT_N() and
+ * GUTS_PHASE() expand to nothing.
+ *
+ * Counts and times accumulate over all projections of the process (of all
+ * threads) until reset(), e.g. over an entire MCMC run. Phase times are
+ * exclusive: time spent in a nested phase (e.g. survival within projection)
+ * is attributed to the nested phase only, so the times of all phases add up.
+ * TK damage and TD gathering alternate per grid point and are counted, not
+ * timed; their time is part of the projection phase.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace guts_instrumentation {
+
+enum counter {
+  damage_calls,     ///< calculate_damage()
+  gather_calls,     ///< gather_effect()
+  survival_calls,   ///< calculate_current_survival()
+  exp_log_calls,    ///< evaluations of exp and log in the kernels
+  sample_calls,     ///< calc_sample() that (re)calculate the threshold sample
+  num_counters
+};
+
+enum phase {
+  phase_calc_sample,   ///< threshold samples
+  phase_projection,    ///< TK damage and TD gathering along the time grid
+  phase_survival,      ///< survival sums
+  phase_loglikelihood, ///< log-likelihood and goodness of fit
+  phase_marshalling,   ///< conversion between R objects and the core
+  num_phases
+};
+
+static const char* const counter_names[num_counters] = {
+  "calculate_damage", "gather_effect", "calculate_current_survival", "exp_log", "calc_sample"
+};
+static const char* const phase_names[num_phases] = {
+  "calc_sample", "projection", "survival", "loglikelihood", "marshalling"
+};
+
+inline bool enabled() {
+#ifdef GUTS_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+} // namespace guts_instrumentation
+
+#ifdef GUTS_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+
+namespace guts_instrumentation {
+
+struct registry {
+  std::atomic<std::uint64_t > counts[num_counters];
+  std::atomic<std::uint64_t > phase_ns[num_phases];
+  std::atomic<std::uint64_t > phase_calls[num_phases];
+};
+
+/// the registry of the process; zero-initialized as a static
+inline registry& get_registry() {
+  static registry r;
+  return r;
+}
+
+inline void count(const counter c, const std::uint64_t n = 1) {
+  get_registry().counts[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+inline void reset() {
+  registry& r = get_registry();
+  for (auto& v : r.counts) v.store(0, std::memory_order_relaxed);
+  for (auto& v : r.phase_ns) v.store(0, std::memory_order_relaxed);
+  for (auto& v : r.phase_calls) v.store(0, std::memory_order_relaxed);
+}
+
+inline std::uint64_t get_count(const counter c) {return get_registry().counts[c].load(std::memory_order_relaxed);}
+inline double get_seconds(const phase p) {return 1e-9 * static_cast<double >(get_registry().phase_ns[p].load(std::memory_order_relaxed));}
+inline std::uint64_t get_calls(const phase p) {return get_registry().phase_calls[p].load(std::memory_order_relaxed);}
+
+/**
+ * \brief times a scope with a monotonic clock
+ * \details Timers nest per thread; the time of a nested timer is subtracted from
+ * the enclosing one.
+ */
+class phase_timer {
+public:
+  explicit phase_timer(const phase new_p) :
+    p(new_p), enclosing(current()), nested_ns(0), start(std::chrono::steady_clock::now()) {
+    current() = this;
+  }
+  ~phase_timer() {
+    const std::uint64_t ns = static_cast<std::uint64_t >(
+      std::chrono::duration_cast<std::chrono::nanoseconds >(std::chrono::steady_clock::now() - start).count());
+    current() = enclosing;
+    if (enclosing) enclosing->nested_ns += ns;
+    registry& r = get_registry();
+    r.phase_ns[p].fetch_add(ns > nested_ns ? ns - nested_ns : 0, std::memory_order_relaxed);
+    r.phase_calls[p].fetch_add(1, std::memory_order_relaxed);
+  }
+  phase_timer(const phase_timer&) = delete;
+  phase_timer& operator=(const phase_timer&) = delete;
+private:
+  static phase_timer*& current() {
+    static thread_local phase_timer* t = nullptr;
+    return t;
+  }
+  const phase p;
+  phase_timer* const enclosing;
+  std::uint64_t nested_ns;
+  const std::chrono::steady_clock::time_point start;
+};
+
+} // namespace guts_instrumentation
+
+#define GUTS_COUNT(c) guts_instrumentation::count(guts_instrumentation::c)
+#define GUTS_COUNT_N(c, n) guts_instrumentation::count(guts_instrumentation::c, static_cast<std::uint64_t >(n))
+#define GUTS_PHASE(p) guts_instrumentation::phase_timer guts_phase_timer_(guts_instrumentation::phase_##p)
+
+#else
+
+namespace guts_instrumentation {
+inline void reset() {}
+inline std::uint64_t get_count(const counter) {return 0;}
+inline double get_seconds(const phase) {return 0;}
+inline std::uint64_t get_calls(const phase) {return 0;}
+} // namespace guts_instrumentation
+
+#define GUTS_COUNT(c) ((void)0)
+#define GUTS_COUNT_N(c, n) ((void)0)
+#define GUTS_PHASE(p) ((void)0)
+
+#endif //GUTS_INSTRUMENTATION
+
+#endif //GUTS_INSTRUMENTATION_H
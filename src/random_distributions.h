@@ -50,6 +50,13 @@ struct lognormal :
 	  double mu = std::log(mn) - sigma_square / 2;
 		return 0.5 + std::erf( (std::log(x)-mu)/std::sqrt(2 * sigma_square) ) / 2;
 	}
+	inline double PDF(const double x) const {
+	  if (!(x > 0)) return 0;
+	  double sigma_square = std::log((sd * sd) / mn / mn + 1);
+	  double mu = std::log(mn) - sigma_square / 2;
+	  double r = std::log(x) - mu;
+		return std::exp(-r * r / (2 * sigma_square)) / (x * std::sqrt(6.283185307179586 * sigma_square));
+	}
 };
 
 class loglogistic_parameters {
@@ -76,6 +83,11 @@ struct loglogistic :
 	inline double CDF(const double x) const final {
 		return 1/(1+std::pow(x/alpha,-beta));
 	}
+	inline double PDF(const double x) const {
+	  if (!(x > 0)) return 0;
+	  double F = CDF(x);
+		return beta * F * (1 - F) / x;
+	}
 };
 
 class delta_parameters {
@@ -5,7 +5,8 @@
  * 2017-10-09 
  * updated: 2019-01-29
  * updated: 2021-11-30
- * updated: 2022-01-17 
+ * updated: 2022-01-17
+ * updated: 2026-10-19
  */
 
 #ifndef SAMPLERS_H
@@ -14,14 +15,23 @@
 #include <limits>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <stdexcept>
+#include "instrumentation.h"
 
 #include "random_distributions.h"
 
+/**
+ * @brief threshold sample on a standardized grid with importance weights
+ * @details The standardized nodes ztmp are equally spaced in [-1, 1] and the weights zw depend on 
+ * the sample size N and the importance sampling rate R only. Both are calculated once in initialize_grid(). 
+ * The variates z are calculated from the threshold parameters in calc_sample() and are only recalculated
+ * if the parameters change.
+ */
 class importance_sampler {
 public:
 	typedef std::vector<double > sample_type;
-  importance_sampler(const std::size_t sample_size = 0) : z(sample_size), zw(sample_size) {}
+  importance_sampler(const std::size_t sample_size = 0) : z(sample_size), zw(sample_size), ztmp(sample_size), sample_valid(false) {}
   virtual ~importance_sampler() {}
   virtual void calc_sample() = 0;
   inline double variate_at(const size_t i) const {return z.at(i);}
@@ -31,8 +41,42 @@ public:
   inline std::vector<double >::const_iterator begin() const {return z.begin();}
   inline std::vector<double >::const_iterator end() const {return z.end();}
 protected:
+  /**
+   * @brief calculates the standardized nodes and resizes variates and weights
+   */
+  void initialize_grid(const std::size_t sample_size) {
+    z.assign(sample_size, 0.0);
+    zw.assign(sample_size, 0.0);
+    ztmp.assign(sample_size, 0.0);
+    for ( std::size_t i = 0; i < sample_size; ++i ) {
+      ztmp[i] = (2.0 * static_cast<double >(i) - static_cast<double >(sample_size) + 1) / 
+        static_cast<double >(sample_size - 1);
+    }
+    sample_valid = false;
+  }
+  /**
+   * @brief sets variates $z_i = e^{ztmp_i \cdot scale + mu}$
+   * @details Nodes are equally spaced, i.e. variates form a geometric sequence.
+   * Variates are calculated by multiplication and reanchored with an exact exponential every 64 nodes.
+   */
+  void scale_sample(const double scale, const double mu) {
+    const std::size_t N = z.size();
+    GUTS_COUNT_N(exp_log_calls, (N + 63) / 64 + 1);
+    if (N < 2) {
+      if (N == 1) z[0] = std::exp(mu);
+      return;
+    }
+    const double q = std::exp(2.0 * scale / static_cast<double >(N - 1));
+    for ( std::size_t i = 0; i < N; ++i ) {
+      z[i] = i % 64 == 0 ? std::exp( ztmp[i] * scale + mu ) : z[i-1] * q;
+    }
+  }
   std::vector<double > z; 
   std::vector<double > zw;
+  ///standardized nodes
+  std::vector<double > ztmp;
+  ///true if z has been calculated for the cached threshold parameters
+  bool sample_valid;
 };
 
 class imp_lognormal : public importance_sampler, public lognormal_parameters {
@@ -43,15 +87,22 @@ public:
   ) : 
   importance_sampler(sample_size),
   lognormal_parameters(),
-  R(importance_sampling_rate) {}
+  R(importance_sampling_rate),
+  sample_mn(std::numeric_limits<double>::quiet_NaN()),
+  sample_sd(std::numeric_limits<double>::quiet_NaN()) {}
   virtual ~imp_lognormal() {}
 	inline void initialize(const std::size_t sample_size) {
-		z.assign(sample_size, 0.0);
-		zw.assign(sample_size, 0.0);
+		initialize_grid(sample_size);
+		for ( std::size_t i = 0; i < sample_size; ++i ) {
+			zw[i] = -0.5 * ztmp[i] * ztmp[i] * R * R;
+		}
 	}
   void calc_sample() final;
     protected:
     double R;
+    ///threshold parameters of the current sample
+    double sample_mn;
+    double sample_sd;
 };
 
 class imp_loglogistic : public importance_sampler, public loglogistic_parameters {
@@ -62,15 +113,24 @@ public:
   ) : 
   importance_sampler(sample_size),
   loglogistic_parameters(),
-  R(importance_sampling_rate) {}
+  R(importance_sampling_rate),
+  sample_alpha(std::numeric_limits<double>::quiet_NaN()),
+  sample_beta(std::numeric_limits<double>::quiet_NaN()) {}
   virtual ~imp_loglogistic() {}
 	inline void initialize(const std::size_t sample_size) {
-		z.assign(sample_size, 0.0);
-		zw.assign(sample_size, 0.0);
+		initialize_grid(sample_size);
+		// loglogistic weights formula
+		// zw.at(i) =  log(R / 2.0)  - 2.0 *  log( cosh( (log(z.at(i)) - mu) / 2.0 / s ) );
+		for ( std::size_t i = 0; i < sample_size; ++i ) {
+			zw[i] = - 2.0 *  log( std::cosh( ztmp[i] * R / 2.0 ) );
+		}
 	}
   void calc_sample() final;
 protected:
   double R;
+  ///threshold parameters of the current sample
+  double sample_alpha;
+  double sample_beta;
 };
 
 class imp_delta : public importance_sampler, public delta_parameters {
@@ -87,24 +147,171 @@ public:
   void calc_sample() override;
 };
 
+inline void imp_lognormal::calc_sample() {
+  if ( sample_valid && mn == sample_mn && sd == sample_sd ) return;
+  GUTS_PHASE(calc_sample);
+  GUTS_COUNT(sample_calls);
+  if ( mn == 0.0 && sd != 0 ) {
+    throw std::domain_error( "mn = 0 and sd != 0 -- incomplete lognormal model ignored." );
+  }
+  double sigma2   =  std::log(   1.0  +  pow( (sd / mn), 2.0 )   );
+  double mu       =  std::log(mn)  -  (0.5 * sigma2);
+  double sigmaD   =  std::sqrt(sigma2) * R;
+  
+  
+  if (sigmaD + mu > 700) {
+    throw std::overflow_error( "Approximating lognormal distribution: infinite variates. Please check parameter values." );
+  }
+  
+  scale_sample(sigmaD, mu);
+  sample_mn = mn;
+  sample_sd = sd;
+  sample_valid = true;
+}
+
+inline void imp_loglogistic::calc_sample() {
+  if ( sample_valid && alpha == sample_alpha && beta == sample_beta ) return;
+  GUTS_PHASE(calc_sample);
+  GUTS_COUNT(sample_calls);
+  // if scale (wpar3]) <= 0 or shape (wpar[4]) <= 0:
+  // the loglogistic distribution is undefined.
+  // These cases are excluded.
+  if (alpha <= 0) {
+    throw std::domain_error( "Loglogistic distribution undefined for scale parameter <= 0. \nPlease check parameter values." );
+  }
+  if (beta <= 0) {
+    throw std::domain_error( "Loglogistic distribution undefined for shape parameter <= 0. \nPlease check parameter values." );
+  } else {
+    /* if shape (wpar4]) <=1: the loglogistic mode = 0 and mean undefined
+    * To avoid loglogistic distributions that peak at 0, wpar[4] <= 1 throws a warning
+    * Excluding this distribution shape still allows approximation of a concentration threshold of 0,
+    * by setting scale \approx 0
+    */
+    if (beta <= 1) {
+      throw std::domain_error( "Approximating loglogistic distribution: \nShape parameter should be above 1 to avoid an unrealistic concentration threshold distribution that peaks at 0. A concentration threshold close to 0 is better described by a scale parameter that approximates 0. \nNummeric approximation might be wrong. Please check parameter values." );
+    }
+  }
+  
+  // parameters are given as alpha = scale and beta = shape
+  // transform parameters to mu and s
+  double mu  = std::log(alpha);
+  double s   =  1 / beta;
+  // if s * R + mu is above 700, z(N-1) -> infty; returning nan for S and LL
+  if (s * R + mu > 700) {
+    throw std::domain_error( "Approximating loglogistic distribution: infinite variates. \nPlease check parameter values." );
+  }
+  
+  scale_sample(s * R, mu);
+  sample_alpha = alpha;
+  sample_beta = beta;
+  sample_valid = true;
+}
+
+inline void imp_delta::calc_sample() {
+  this->z.assign(this->z.size(), z_val);
+  this->zw.assign(this->z.size(), 0.0);
+}
+
+/**
+ * @brief sorted random sample, optionally with probability weights
+ * @details Without weights all variates have equal weight. Weighted samples 
+ * (e.g. compressed with compress_sorted_sample()) also hold the sums of 
+ * weights at and above each variate, and the size of the sample they 
+ * represent.
+ */
 template<typename tz >
 class random_sample  {
 public:
 	typedef tz sample_type;
-  random_sample() : z() {}
+  random_sample() : z(), w(), W(), n(0) {}
   virtual ~random_sample() {}
   inline double variate_at(const size_t i) const {return z.at(i);}
-  inline void set_variates(const tz& variates) {z = variates;}
+  inline void set_variates(const tz& variates) {
+    z = variates;
+    w = tz();
+    W = tz();
+    n = static_cast<double >(z.size());
+  }
 	void set_variates(typename tz::const_iterator begin, typename tz::const_iterator end) {
 		z.assign(begin, end);
+		w = tz();
+		W = tz();
+		n = static_cast<double >(z.size());
 	}
+  /**
+   * @brief sets sorted variates with probability weights
+   * @param[in] variates sorted variates
+   * @param[in] weights probability weights of the variates (summing up to 1), empty for equal weights
+   * @param[in] upper_weights sums of the weights of all variates at and above each variate
+   * @param[in] raw_size size of the sample the weights were calculated from
+   */
+  inline void set_variates(const tz& variates, const tz& weights, const tz& upper_weights, const double raw_size) {
+    z = variates;
+    w = weights;
+    W = upper_weights;
+    n = raw_size;
+  }
   tz get_variates() const {return z;}
   double variate_back() const {return *(z.end()-1);}
   std::size_t sample_size() const {return z.size();}
+  /// size of the sample the (weighted) variates represent
+  inline double raw_sample_size() const {return n;}
+  inline bool is_weighted() const {return w.size() > 0;}
+  inline double weight_at(const size_t i) const {return w[i];}
+  inline double upper_weight_at(const size_t i) const {return W[i];}
   inline typename tz::const_iterator begin() const {return z.begin();}
   inline typename tz::const_iterator end() const {return z.end();}
 protected:
   tz z;
+  ///probability weights
+  tz w;
+  ///sums of weights at and above each variate
+  tz W;
+  ///size of the raw sample
+  double n;
 };
 
+/**
+ * @brief compresses a sorted sample into weighted quantiles
+ * @details Consecutive blocks of $m = 2 \lfloor \epsilon n \rfloor + 1$ variates are represented by their 
+ * median with weight $m / n$, and equal values are merged. The CDF of the compressed sample deviates 
+ * from the empirical CDF of the sample by at most $\epsilon$ (0 merges equal values only).
+ * @param[in] sorted sorted sample of size n
+ * @param[in] max_cdf_error maximum deviation $\epsilon$ of the CDF
+ * @param[out] z compressed variates
+ * @param[out] w probability weights
+ * @param[out] W sums of weights at and above each variate
+ */
+template<typename tSample >
+void compress_sorted_sample(
+    const tSample& sorted,
+    const double max_cdf_error,
+    std::vector<double >& z,
+    std::vector<double >& w,
+    std::vector<double >& W
+) {
+  const std::size_t n = sorted.size();
+  if (!(max_cdf_error >= 0)) throw std::domain_error("Maximum CDF error must be non-negative.");
+  const std::size_t m = 2 * static_cast<std::size_t >(std::floor(max_cdf_error * static_cast<double >(n))) + 1;
+  z.resize(0);
+  w.resize(0);
+  for (std::size_t i = 0; i < n; i += m) {
+    const std::size_t block = std::min(m, n - i);
+    const double v = sorted[i + (block - 1) / 2];
+    const double wv = static_cast<double >(block) / static_cast<double >(n);
+    if (!z.empty() && z.back() == v) {
+      w.back() += wv;
+    } else {
+      z.push_back(v);
+      w.push_back(wv);
+    }
+  }
+  W.assign(z.size(), 0.0);
+  double S = 0;
+  for (std::size_t u = z.size(); u > 0; --u) {
+    S += w[u-1];
+    W[u-1] = S;
+  }
+}
+
 #endif //SAMPLERS_H
@@ -0,0 +1,166 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Tests of the adjoint derivatives of survival with respect to the exposure.
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "GUTS_RED.h"
+#include "GUTS_RED_adjoint.h"
+#include "external_data.h"
+
+typedef std::vector<double > tv;
+
+static int failures = 0;
+
+static void expect_near(const char* what, const char* of, const std::size_t k, const double value, const double expected, const double tol) {
+  if (!(std::fabs(value - expected) <= tol)) {
+    std::printf("FAILED %s, %s[%zu]: %.9g, expected %.9g\n", what, of, k, value, expected);
+    ++failures;
+  }
+}
+
+const tv Ct = {0, 1, 2.5, 3, 4, 5};
+const tv C = {0, 5, 1, 0, 3, 3};
+const tv yt = {0, 1, 2, 3, 4, 5};
+const std::vector<int > y = {20, 18, 15, 11, 8, 6};
+const std::size_t M = 997;
+const std::size_t N = 200;
+
+typedef external_data<tv, tv, true, true > tdat;
+typedef external_data<tv, tv, false, false > tdat_IT;
+
+template<typename tProjector, typename tData >
+tv project_exposure(const tv& new_Ct, const tv& new_C, const tv& par) {
+  tData dat;
+  dat.set_data_unchecked(new_Ct, new_C, yt, M, N, 1.0);
+  tProjector proj;
+  proj.initialize(dat);
+  return project(proj, par);
+}
+
+template<typename tProjector >
+tv project_exposure_IT(const tv& new_Ct, const tv& new_C, const tv& par) {
+  tdat_IT dat;
+  dat.set_data_unchecked(new_Ct, new_C, yt, 1.0);
+  tProjector proj;
+  proj.initialize(dat);
+  return project(proj, par);
+}
+
+static double objective_of(const survival_objective objective, const tv& S) {
+  return objective == survival_objective::final_survival ? S.back() : calculate_loglikelihood(S, y);
+}
+
+/**
+ * compares survival and the derivatives with central finite differences of the projection
+ * (derivatives with respect to Ct[0] and Ct.back() are not compared, as they move the bounds of the exposure)
+ */
+template<typename tProject >
+void expect_derivatives(const char* what, const tProject& project_at, const survival_objective objective,
+    const exposure_sensitivity& res) {
+  const tv S = project_at(Ct, C);
+  for (std::size_t i = 0; i < S.size(); ++i) expect_near(what, "S", i, res.S[i], S[i], 1e-10);
+  expect_near(what, "value", 0, res.value, objective_of(objective, S), 1e-9);
+  const double h = 1e-6;
+  for (std::size_t k = 0; k < C.size(); ++k) {
+    tv Cp(C), Cm(C);
+    Cp[k] += h;
+    Cm[k] -= h;
+    const double fd = (objective_of(objective, project_at(Ct, Cp)) - objective_of(objective, project_at(Ct, Cm))) / (2 * h);
+    expect_near(what, "dC", k, res.dC[k], fd, 1e-5 * (1 + std::fabs(fd)));
+  }
+  for (std::size_t k = 1; k + 1 < Ct.size(); ++k) {
+    tv Ctp(Ct), Ctm(Ct);
+    Ctp[k] += h;
+    Ctm[k] -= h;
+    const double fd = (objective_of(objective, project_at(Ctp, C)) - objective_of(objective, project_at(Ctm, C))) / (2 * h);
+    expect_near(what, "dCt", k, res.dCt[k], fd, 1e-5 * (1 + std::fabs(fd)));
+  }
+}
+
+int main() {
+  tdat dat;
+  dat.set_data(Ct, C, yt, M, N, 1.0);
+  tdat_IT dat_IT;
+  dat_IT.set_data(Ct, C, yt, 1.0);
+  const survival_objective objectives[] = {survival_objective::final_survival, survival_objective::loglikelihood};
+
+  for (const survival_objective objective : objectives) {
+    // SD
+    {
+      const tv par = {0.02, 0.8, 0.6, 1.5};
+      exposure_sensitivity res;
+      hazard_exposure_sensitivity(dat, par[1], par[2], par[0], fixed_hazard_threshold(par[3]), objective, y, true, res);
+      expect_derivatives("SD",
+        [&par](const tv& new_Ct, const tv& new_C) {
+          return project_exposure<guts_projector<guts_RED<tv, tv, TD_SD, tv >, tv, tv >, tdat >(new_Ct, new_C, par);
+        }, objective, res);
+    }
+    // Proper, importance sample of a lognormal distribution
+    {
+      const tv par = {0.02, 0.8, 0.6, 1.5, 0.8};
+      imp_lognormal samp;
+      samp.initialize(N);
+      samp.set_threshold_mean(par[3]);
+      samp.set_threshold_sd(par[4]);
+      samp.calc_sample();
+      exposure_sensitivity res;
+      hazard_exposure_sensitivity(dat, par[1], par[2], par[0], importance_hazard_thresholds(samp), objective, y, true, res);
+      expect_derivatives("Proper lognormal",
+        [&par](const tv& new_Ct, const tv& new_C) {
+          return project_exposure<guts_projector<guts_RED<tv, tv, TD_proper_lognormal, tv >, tv, tv >, tdat >(new_Ct, new_C, par);
+        }, objective, res);
+    }
+    // Proper, external sample with merged variates
+    {
+      const tv par = {0.02, 0.8, 0.6};
+      const tv sample = {0.5, 1, 1, 1.5, 2, 2, 3};
+      tv z, w, W;
+      compress_sorted_sample(sample, 0, z, w, W);
+      exposure_sensitivity res;
+      hazard_exposure_sensitivity(dat, par[1], par[2], par[0], sample_hazard_thresholds(z, w, sample.size()), objective, y, true, res);
+      expect_derivatives("Proper external",
+        [&](const tv& new_Ct, const tv& new_C) {
+          tdat dat_sample;
+          dat_sample.set_data_unchecked(new_Ct, new_C, yt, M, N, 1.0);
+          guts_projector<guts_RED<tv, tv, TD<random_sample<tv >, 'P' >, tv >, tv, tv > proj;
+          proj.initialize(dat_sample);
+          proj.samp.set_variates(z, w, W, static_cast<double >(sample.size()));
+          return project(proj, par);
+        }, objective, res);
+    }
+    // IT, loglogistic distribution
+    {
+      const tv par = {0.02, 0.8, NAN, 2, 3};
+      loglogistic dist;
+      dist.set_threshold_alpha(par[3]);
+      dist.set_threshold_beta(par[4]);
+      exposure_sensitivity res;
+      tolerance_exposure_sensitivity(dat_IT, par[1], par[0], dist, objective, y, true, res);
+      expect_derivatives("IT loglogistic",
+        [&par](const tv& new_Ct, const tv& new_C) {
+          return project_exposure_IT<guts_projector_fastIT<guts_RED<tv, tv, TD_IT_loglogistic, tv >, tv, tv > >(new_Ct, new_C, par);
+        }, objective, res);
+    }
+    // IT, lognormal distribution
+    {
+      const tv par = {0.02, 0.8, NAN, 2, 1};
+      lognormal dist;
+      dist.set_threshold_mean(par[3]);
+      dist.set_threshold_sd(par[4]);
+      exposure_sensitivity res;
+      tolerance_exposure_sensitivity(dat_IT, par[1], par[0], dist, objective, y, true, res);
+      expect_derivatives("IT lognormal",
+        [&par](const tv& new_Ct, const tv& new_C) {
+          return project_exposure_IT<guts_projector_fastIT<guts_RED<tv, tv, TD_IT_lognormal, tv >, tv, tv > >(new_Ct, new_C, par);
+        }, objective, res);
+    }
+  }
+
+  if (failures == 0) std::printf("All adjoint tests passed.\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+# Runs a job of guts_batch as a whole and in shards; the merged shards must equal the whole.
+# Variables: BATCH (executable), SOURCE_DIR (with job and data files), WORK_DIR
+file(MAKE_DIRECTORY ${WORK_DIR})
+file(COPY ${SOURCE_DIR}/job_Proper.txt ${SOURCE_DIR}/parameters_Proper.txt DESTINATION ${WORK_DIR})
+
+function(run_batch)
+  execute_process(COMMAND ${BATCH} ${ARGN} RESULT_VARIABLE status ERROR_VARIABLE err)
+  if(NOT status EQUAL 0)
+    message(FATAL_ERROR "guts_batch ${ARGN} failed: ${err}")
+  endif()
+endfunction()
+
+run_batch(store --out ${WORK_DIR}/profiles.gex ${SOURCE_DIR}/profiles.txt)
+run_batch(run --job ${WORK_DIR}/job_Proper.txt --format csv --out ${WORK_DIR}/whole.csv)
+set(shards)
+# 12 items in 5 shards of 2 or 3 items, which split the profiles of parameter sets
+foreach(i 0 1 2 3 4)
+  run_batch(run --job ${WORK_DIR}/job_Proper.txt --shard ${i}/5 --threads 2 --out ${WORK_DIR}/shard${i}.bin)
+  list(APPEND shards ${WORK_DIR}/shard${i}.bin)
+endforeach()
+list(REVERSE shards)
+run_batch(merge --format csv --out ${WORK_DIR}/merged.csv ${shards})
+
+file(READ ${WORK_DIR}/whole.csv whole)
+file(READ ${WORK_DIR}/merged.csv merged)
+if(NOT whole STREQUAL merged)
+  message(FATAL_ERROR "Merged shards differ from the whole job.")
+endif()
+string(REGEX MATCHALL "\n" lines "${whole}")
+list(LENGTH lines n)
+if(NOT n EQUAL 13)
+  message(FATAL_ERROR "Expected a header and 12 items, got ${n} lines.")
+endif()
+
+# incomplete shards are rejected unless --allow-partial is given, overlapping shards are rejected
+file(REMOVE ${WORK_DIR}/partial.csv)
+execute_process(COMMAND ${BATCH} merge --format csv --out ${WORK_DIR}/partial.csv ${WORK_DIR}/shard1.bin ${WORK_DIR}/shard2.bin
+  RESULT_VARIABLE status ERROR_QUIET)
+if(status EQUAL 0 OR EXISTS ${WORK_DIR}/partial.csv)
+  message(FATAL_ERROR "Incomplete shards were merged without --allow-partial.")
+endif()
+run_batch(merge --format csv --allow-partial --out ${WORK_DIR}/partial.csv ${WORK_DIR}/shard1.bin ${WORK_DIR}/shard2.bin)
+file(STRINGS ${WORK_DIR}/partial.csv partial)
+list(LENGTH partial n)
+if(NOT n EQUAL 6)
+  message(FATAL_ERROR "Expected a header and 5 items of shards 1 and 2, got ${n} lines.")
+endif()
+execute_process(COMMAND ${BATCH} merge --out ${WORK_DIR}/overlap.bin ${WORK_DIR}/shard1.bin ${WORK_DIR}/shard1.bin
+  RESULT_VARIABLE status ERROR_QUIET)
+if(status EQUAL 0)
+  message(FATAL_ERROR "Overlapping shards were merged.")
+endif()
+
+# unknown formats are rejected
+execute_process(COMMAND ${BATCH} run --job ${WORK_DIR}/job_Proper.txt --format cvs --out ${WORK_DIR}/typo.csv
+  RESULT_VARIABLE status ERROR_QUIET)
+if(status EQUAL 0)
+  message(FATAL_ERROR "Unknown format was accepted.")
+endif()
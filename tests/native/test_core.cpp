@@ -0,0 +1,155 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Tests of the header-only core without R.
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+#include "GUTS_RED.h"
+#include "external_data.h"
+
+typedef std::vector<double > tv;
+
+static int failures = 0;
+
+static void expect_near(const char* what, const double value, const double expected, const double tol) {
+  if (!(std::fabs(value - expected) <= tol)) {
+    std::printf("FAILED %s: %.9f, expected %.9f\n", what, value, expected);
+    ++failures;
+  }
+}
+
+static void expect_survival(const char* what, const tv& p, const tv& expected, const double tol) {
+  if (p.size() != expected.size()) {
+    std::printf("FAILED %s: %zu survival probabilities, expected %zu\n", what, p.size(), expected.size());
+    ++failures;
+    return;
+  }
+  for (std::size_t i = 0; i < p.size(); ++i) expect_near(what, p[i], expected[i], tol);
+}
+
+const tv Ct = {0, 1, 2, 3, 4};
+const tv C = {4, 2, 4, 6, 6};
+const tv yt = {0, 1, 2, 3, 4};
+const tv y = {10, 3, 2, 1, 0};
+
+template<typename TD_mod >
+tv project_on_grid(const tv& par, const tv& conc) {
+  external_data<tv, tv, true, true > dat;
+  dat.set_data(Ct, conc, yt, 10000, 10000, 1.0);
+  guts_projector<guts_RED<tv, tv, TD_mod, tv >, tv, tv > proj;
+  proj.initialize(dat);
+  return project(proj, par);
+}
+
+template<typename TD_mod >
+tv project_fast_IT(const tv& par) {
+  external_data<tv, tv, false, false > dat;
+  dat.set_data(Ct, C, yt, 1.0);
+  guts_projector_fastIT<guts_RED<tv, tv, TD_mod, tv >, tv, tv > proj;
+  proj.initialize(dat);
+  return project(proj, par);
+}
+
+/// IT survival of fastIT and of the time grid with M steps for exposure conc at times conc_t
+template<typename TD_mod >
+void compare_fast_IT_to_grid(const tv& par, const tv& conc_t, const tv& conc, const tv& surv_t, tv& fast, tv& grid) {
+  external_data<tv, tv, false, false > dat;
+  dat.set_data(conc_t, conc, surv_t, 1.0);
+  guts_projector_fastIT<guts_RED<tv, tv, TD_mod, tv >, tv, tv > proj_fast;
+  proj_fast.initialize(dat);
+  fast = project(proj_fast, par);
+  external_data<tv, tv, true, false > dat_grid;
+  dat_grid.set_data(conc_t, conc, surv_t, 100000, 1.0);
+  guts_projector<guts_RED<tv, tv, TD_mod, tv >, tv, tv > proj_grid;
+  proj_grid.initialize(dat_grid);
+  grid = project(proj_grid, par);
+}
+
+int main() {
+  const tv p_SD = project_on_grid<TD_SD >({1e-5, 1.3, 0.1, 3}, C);
+  expect_survival("SD", p_SD, {1.0, 0.99999, 0.99998, 0.9319453, 0.7475945}, 1e-6);
+  expect_near("SD loglikelihood", calculate_loglikelihood(p_SD, y), -96.48211, 1e-4);
+
+  expect_survival("Proper lognormal", project_on_grid<TD_proper_lognormal >({0, 1.3, 0.07, 3, 2}, C),
+    {1.0, 0.9923859, 0.9683345, 0.8941076, 0.7645970}, 1e-6);
+  expect_survival("IT loglogistic", project_fast_IT<TD_IT_loglogistic >({0, 1.3, NAN, 3, 2}),
+    {1.0, 0.6860702, 0.5188876, 0.3004231, 0.2222245}, 1e-6);
+
+  // fastIT finds damage maxima within concentration intervals
+  {
+    tv fast, grid;
+    // a maximum in interval [1, 10] (C[1] = 10 > Ct[1] = 1 decides that there is a maximum)
+    compare_fast_IT_to_grid<TD_IT_loglogistic >({0, 1, NAN, 8, 5}, {0, 1, 10, 20}, {10, 10, 0, 0}, {0, 20}, fast, grid);
+    expect_survival("IT maximum with C[k] != Ct[k]", fast, grid, 1e-4);
+    // a maximum between Ct[1] = 9 and the survival time 15 in the last concentration interval
+    compare_fast_IT_to_grid<TD_IT_loglogistic >({0, 0.3, NAN, 8, 5}, {0, 9, 20}, {10, 10, 0}, {0, 15}, fast, grid);
+    expect_survival("IT maximum before the survival time", fast, grid, 1e-4);
+  }
+
+  // an uncompressed weighted sample gives the Proper survival of its raw sample
+  {
+    tv raw_par = {0, 1.3, 0.07};
+    for (int u = 0; u < 200; ++u) raw_par.push_back(2 + 0.05 * (u / 2));
+    const tv sample(raw_par.begin() + 3, raw_par.end());
+    tv z, w, W;
+    compress_sorted_sample(sample, 0, z, w, W);
+    external_data<tv, tv, true, true > dat_sample;
+    dat_sample.set_data(Ct, C, yt, 10000, sample.size(), 1.0);
+    guts_projector<guts_RED<tv, tv, TD<random_sample<tv >, 'P' >, tv >, tv, tv > proj_raw, proj_weighted;
+    proj_raw.initialize(dat_sample);
+    proj_weighted.initialize(dat_sample);
+    proj_weighted.samp.set_variates(z, w, W, static_cast<double >(sample.size()));
+    expect_survival("Proper weighted sample", project(proj_weighted, tv({0, 1.3, 0.07})), project(proj_raw, raw_par), 1e-12);
+  }
+
+  // the closed form for constant exposure agrees with the time grid
+  const tv C_constant(Ct.size(), 5.0);
+  external_data<tv, tv, true, false > dat;
+  dat.set_data(Ct, C_constant, yt, 10000, 1.0);
+  guts_projector_constant_exposure<guts_RED<tv, tv, TD_SD, tv >, tv, tv > closed_form;
+  closed_form.initialize(dat);
+  expect_survival("SD constant exposure", project(closed_form, tv({1e-5, 1.3, 0.1, 3})),
+    project_on_grid<TD_SD >({1e-5, 1.3, 0.1, 3}, C_constant), 1e-4);
+
+  // the closed form refuses time-varying exposure
+  external_data<tv, tv, true, false > dat_varying;
+  dat_varying.set_data(Ct, C, yt, 10000, 1.0);
+  if (!is_constant_exposure(dat) || is_constant_exposure(dat_varying)) {
+    std::printf("FAILED constant exposure not detected\n");
+    ++failures;
+  }
+  try {
+    closed_form.initialize(dat_varying);
+    project(closed_form, tv({1e-5, 1.3, 0.1, 3}));
+    std::printf("FAILED closed form projected time-varying exposure\n");
+    ++failures;
+  } catch (const std::invalid_argument&) {}
+
+  // data are checked
+  try {
+    external_data<tv, tv, false, false > unsorted;
+    unsorted.set_data({0, 2, 1}, {1, 1, 1}, {0, 1}, 1.0);
+    std::printf("FAILED unsorted concentration times accepted\n");
+    ++failures;
+  } catch (const std::invalid_argument&) {}
+
+  // first and last elements of empty containers are refused
+  try {
+    back(tv());
+    std::printf("FAILED back() of an empty vector\n");
+    ++failures;
+  } catch (const std::out_of_range&) {}
+  try {
+    front(tv());
+    std::printf("FAILED front() of an empty vector\n");
+    ++failures;
+  } catch (const std::out_of_range&) {}
+
+  if (failures == 0) std::printf("all core tests passed\n");
+  return failures == 0 ? 0 : 1;
+}
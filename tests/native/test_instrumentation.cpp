@@ -0,0 +1,76 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Tests of the counters and phase timers, compiled with GUTS_INSTRUMENTATION.
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#include <cstdio>
+#include <vector>
+#include "GUTS_RED.h"
+#include "external_data.h"
+
+#ifndef GUTS_INSTRUMENTATION
+#error "Compile with -DGUTS_INSTRUMENTATION"
+#endif
+
+typedef std::vector<double > tv;
+using namespace guts_instrumentation;
+
+static int failures = 0;
+
+static void expect_count(const char* what, const std::uint64_t value, const std::uint64_t lo, const std::uint64_t hi) {
+  if (value < lo || value > hi) {
+    std::printf("FAILED %s: %llu, expected %llu to %llu\n", what,
+      static_cast<unsigned long long >(value), static_cast<unsigned long long >(lo), static_cast<unsigned long long >(hi));
+    ++failures;
+  }
+}
+
+const tv Ct = {0, 1, 2, 3, 4};
+const tv C = {4, 2, 4, 6, 6};
+const tv yt = {0, 1, 2, 3, 4};
+const tv y = {10, 3, 2, 1, 0};
+const std::size_t M = 1000;
+const std::size_t N = 500;
+
+int main() {
+  external_data<tv, tv, true, true > dat;
+  dat.set_data(Ct, C, yt, M, N, 1.0);
+
+  reset();
+  guts_projector<guts_RED<tv, tv, TD_SD, tv >, tv, tv > SD;
+  SD.initialize(dat);
+  const tv p = project(SD, tv({1e-5, 1.3, 0.1, 3}));
+  calculate_loglikelihood(p, y);
+  // damage and effect once per grid point, survival once per survival time
+  expect_count("SD damage", get_count(damage_calls), M - 1, M + Ct.size());
+  expect_count("SD gather", get_count(gather_calls), M - 1, M + 1);
+  expect_count("SD survival", get_count(survival_calls), yt.size(), yt.size());
+  expect_count("SD samples", get_count(sample_calls), 0, 0);
+  expect_count("SD projection phase", get_calls(phase_projection), 1, 1);
+  expect_count("SD survival phase", get_calls(phase_survival), yt.size(), yt.size());
+  expect_count("SD loglikelihood phase", get_calls(phase_loglikelihood), 1, 1);
+
+  reset();
+  expect_count("reset", get_count(damage_calls), 0, 0);
+  guts_projector<guts_RED<tv, tv, TD_proper_lognormal, tv >, tv, tv > proper;
+  proper.initialize(dat);
+  project(proper, tv({0, 1.3, 0.07, 3, 2}));
+  project(proper, tv({0, 1.5, 0.07, 3, 2}));
+  // the threshold sample is calculated once for equal threshold parameters
+  expect_count("Proper samples", get_count(sample_calls), 1, 1);
+  expect_count("Proper calc_sample phase", get_calls(phase_calc_sample), 1, 1);
+  // at least one exp per threshold and survival time (except at time 0)
+  expect_count("Proper exp", get_count(exp_log_calls), 2 * N, ~std::uint64_t(0));
+
+  // exclusive phase times add up to at most the wall time
+  const double total = get_seconds(phase_calc_sample) + get_seconds(phase_projection) + get_seconds(phase_survival);
+  if (!(total > 0)) {
+    std::printf("FAILED phase times: %g\n", total);
+    ++failures;
+  }
+
+  if (failures == 0) std::printf("all instrumentation tests passed\n");
+  return failures == 0 ? 0 : 1;
+}
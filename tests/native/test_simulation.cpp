@@ -0,0 +1,127 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Tests of the individual-based simulation of survivors.
+ * License GPL-2
+ * 2026-10-19
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "GUTS_RED.h"
+#include "GUTS_RED_simulation.h"
+#include "external_data.h"
+
+typedef std::vector<double > tv;
+
+static int failures = 0;
+
+static void expect_near(const char* what, const double value, const double expected, const double tol) {
+  if (!(std::fabs(value - expected) <= tol)) {
+    std::printf("FAILED %s: %.9f, expected %.9f\n", what, value, expected);
+    ++failures;
+  }
+}
+
+const tv Ct = {0, 1, 2, 3, 4};
+const tv C = {4, 2, 4, 6, 6};
+const tv yt = {0, 1, 2, 3, 4};
+
+const std::size_t n = 1000;
+const std::size_t R = 100;
+
+/// mean fraction of survivors over replicates (column-major y with R rows)
+template<typename tMortality, typename tThreshold >
+tv simulate_fraction(const tMortality& mortality, const tThreshold& threshold, const std::uint64_t seed, const std::size_t threads,
+    std::vector<int >& y) {
+  y.assign(R * yt.size(), -1);
+  simulate_replicates(mortality, threshold, n, R, seed, 0, threads, y.data(), R, 0);
+  tv S(yt.size(), 0.0);
+  for (std::size_t i = 0; i < yt.size(); ++i) {
+    for (std::size_t r = 0; r < R; ++r) S[i] += y[r + i * R];
+    S[i] /= static_cast<double >(n * R);
+  }
+  return S;
+}
+
+static void expect_survival(const char* what, const tv& S, const tv& expected) {
+  for (std::size_t i = 0; i < S.size(); ++i) {
+    // four standard errors of the mean of n * R individuals
+    expect_near(what, S[i], expected[i], 4 * std::sqrt(expected[i] * (1 - expected[i]) / (n * R)) + 1e-3);
+  }
+}
+
+int main() {
+  external_data<tv, tv, true, true > dat;
+  dat.set_data(Ct, C, yt, 10000, 10000, 1.0);
+  std::vector<int > y, y_threads;
+
+  // SD
+  {
+    const tv par = {1e-5, 1.3, 0.1, 3};
+    guts_projector<guts_RED<tv, tv, TD_SD, tv >, tv, tv > proj;
+    proj.initialize(dat);
+    hazard_mortality mortality;
+    mortality.initialize(dat, par[1], par[2], par[0]);
+    expect_survival("SD", simulate_fraction(mortality, fixed_threshold(par[3]), 1, 1, y), project(proj, par));
+  }
+
+  // Proper
+  {
+    const tv par = {0.02, 1.3, 0.07, 3, 2};
+    guts_projector<guts_RED<tv, tv, TD_proper_lognormal, tv >, tv, tv > proj;
+    proj.initialize(dat);
+    hazard_mortality mortality;
+    mortality.initialize(dat, par[1], par[2], par[0]);
+    const tv S = simulate_fraction(mortality, lognormal_threshold(par[3], par[4]), 2, 1, y);
+    expect_survival("Proper lognormal", S, project(proj, par));
+    // streams are per replicate, not per thread
+    simulate_fraction(mortality, lognormal_threshold(par[3], par[4]), 2, 4, y_threads);
+    if (y != y_threads) {
+      std::printf("FAILED Proper lognormal: simulations differ between 1 and 4 threads\n");
+      ++failures;
+    }
+    simulate_fraction(mortality, lognormal_threshold(par[3], par[4]), 3, 1, y_threads);
+    if (y == y_threads) {
+      std::printf("FAILED Proper lognormal: simulations equal for different seeds\n");
+      ++failures;
+    }
+  }
+
+  // Proper, external sample: the threshold at infinity of the projection is drawn as well
+  {
+    const tv z = {0.5, 1};
+    const tv par = {0.02, 1.3, 2, 0.5, 1};
+    guts_projector<guts_RED<tv, tv, TD<random_sample<tv >, 'P' >, tv >, tv, tv > proj;
+    proj.initialize(dat);
+    hazard_mortality mortality;
+    mortality.initialize(dat, par[1], par[2], par[0]);
+    const tv S = project(proj, par);
+    expect_survival("Proper sample", simulate_fraction(mortality, sample_threshold(z, tv(), 1.0 / z.size()), 6, 2, y), S);
+    const tv W = {1, 0.5};
+    expect_survival("Proper weighted sample", simulate_fraction(mortality, sample_threshold(z, W, 1.0 / z.size()), 7, 2, y), S);
+  }
+
+  // IT
+  {
+    const tv par = {0.02, 1.3, NAN, 3, 2};
+    external_data<tv, tv, false, false > dat_IT;
+    dat_IT.set_data(Ct, C, yt, 1.0);
+    guts_projector_fastIT<guts_RED<tv, tv, TD_IT_loglogistic, tv >, tv, tv > proj;
+    proj.initialize(dat_IT);
+    tolerance_mortality mortality;
+    mortality.initialize(dat_IT, par[1], par[0]);
+    expect_survival("IT loglogistic", simulate_fraction(mortality, loglogistic_threshold(par[3], par[4]), 4, 2, y), project(proj, par));
+
+    // a weighted sample with two thresholds
+    const tv z = {1, 10};
+    const tv W = {1, 0.25};
+    tolerance_mortality no_background;
+    no_background.initialize(dat_IT, par[1], 0);
+    const tv S = simulate_fraction(no_background, sample_threshold(z, W), 5, 2, y);
+    expect_near("IT sample", S.back(), 0.25, 0.01);
+  }
+
+  if (failures == 0) std::printf("All simulation tests passed.\n");
+  return failures == 0 ? 0 : 1;
+}
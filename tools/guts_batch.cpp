@@ -0,0 +1,455 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Batch runner of forecasts for many parameter sets and exposure profiles, with shards.
+ * License GPL-2
+ * 2026-10-19
+ *
+ * Usage:
+ *   guts_batch run --job FILE [--shard i/n] [--threads 1] [--out FILE] [--format bin|csv]
+ *   guts_batch merge --out FILE [--format bin|csv] [--allow-partial] SHARD_FILE...
+ *   guts_batch store --out FILE PROFILE_FILE
+ *
+ * The job file holds one field per line, a key followed by its values:
+ *   model Proper          (SD, IT or Proper)
+ *   dist lognormal        (lognormal or loglogistic; delta for Proper; not used for SD)
+ *   M 10000               (time grid points; not used for IT)
+ *   N 1000                (threshold sample size; used for Proper only)
+ *   SVR 1                 (optional)
+ *   yt 0 1 2 ...          (survival time points of the forecast)
+ *   parameters pars.txt   (one parameter set per line, as in R: hb, kd, [kk,] threshold parameters)
+ *   exposure profiles.gex (exposure store written by guts_write_exposure_store())
+ *   LPx 10 50             (optional effect levels in percent)
+ * Lines starting with # are ignored. Relative file names are relative to the job file.
+ *
+ * The job consists of K = P * Q items, one per parameter set p and profile q, in the
+ * order k = p * Q + q. Shard i/n (0 <= i < n) covers the items from floor(i K / n) to
+ * floor((i + 1) K / n) - 1, i.e. shards are deterministic, contiguous and cover the job
+ * for any n. For each item the survival probabilities at yt and the multiplication
+ * factors LPx are calculated as in guts_calc_profiles(). Profiles of one parameter set
+ * are projected on --threads threads.
+ *
+ * Binary results (native byte order, all fields 8-byte aligned):
+ *   - header of 64 bytes: magic "GUTSBTCH", version (uint32), byte order mark
+ *     0x01020304 (uint32), K, Q, first item, end item (exclusive), number of survival
+ *     times T and of effect levels X (all uint64)
+ *   - T survival times and X effect levels (double)
+ *   - per item from first to end: T survival probabilities and X factors (double)
+ * CSV results have the columns parameter_set and profile (both counted from 1),
+ * S_<yt> and LP<x>. merge checks that the shards belong to the same job and cover a
+ * contiguous range without gaps or overlaps, and writes them as one result. Shards
+ * that do not cover the whole job are an error, unless --allow-partial is given.
+ *
+ * store converts a text file of exposure profiles to an exposure store. Each line holds
+ * a profile name, a concentration time point and a concentration; a profile consists of
+ * consecutive lines with the same name.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "GUTS_RED.h"
+#include "GUTS_RED_profiles.h"
+#include "exposure_store.h"
+#include "external_data.h"
+
+typedef std::vector<double > tv;
+
+namespace {
+
+const char magic[8] = {'G', 'U', 'T', 'S', 'B', 'T', 'C', 'H'};
+const std::uint32_t version = 1;
+const std::uint32_t byte_order_mark = 0x01020304;
+
+struct job {
+  std::string model, dist;
+  std::size_t M, N;
+  double SVR;
+  tv yt, LPx;
+  std::string parameters, exposure;
+};
+
+/// the part of a job result in one file
+struct result_header {
+  std::uint64_t K, Q, first, end, T, X;
+  tv yt, LPx;
+  inline std::uint64_t values_per_item() const {return T + X;}
+};
+
+struct options {
+  std::string command, job, out;
+  std::size_t shard, num_shards, threads;
+  bool csv, allow_partial;
+  std::vector<std::string > inputs;
+};
+
+options parse_options(int argc, char** argv) {
+  if (argc < 2) throw std::invalid_argument("Need a command: run, merge or store.");
+  options o;
+  o.command = argv[1];
+  o.shard = 0;
+  o.num_shards = 1;
+  o.threads = 1;
+  o.csv = false;
+  o.allow_partial = false;
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.compare(0, 2, "--") != 0) {
+      o.inputs.push_back(arg);
+      continue;
+    }
+    if (arg == "--allow-partial") {
+      o.allow_partial = true;
+      continue;
+    }
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + arg + ".");
+    const std::string value = argv[++i];
+    if (arg == "--job") o.job = value;
+    else if (arg == "--out") o.out = value;
+    else if (arg == "--threads") o.threads = std::max<std::size_t >(std::stoul(value), 1);
+    else if (arg == "--format") {
+      if (value != "bin" && value != "csv") throw std::invalid_argument("Unknown format " + value + "; use bin or csv.");
+      o.csv = value == "csv";
+    }
+    else if (arg == "--shard") {
+      const std::size_t slash = value.find('/');
+      if (slash == std::string::npos) throw std::invalid_argument("Shard must be given as i/n.");
+      o.shard = std::stoul(value.substr(0, slash));
+      o.num_shards = std::stoul(value.substr(slash + 1));
+      if (o.num_shards == 0 || o.shard >= o.num_shards) throw std::invalid_argument("Shard i/n needs 0 <= i < n.");
+    }
+    else throw std::invalid_argument("Unknown option " + arg + ".");
+  }
+  if (o.command == "run" && o.job.empty()) throw std::invalid_argument("Need a job file (--job).");
+  if (o.command == "merge" && (o.out.empty() || o.inputs.empty())) throw std::invalid_argument("Need --out and the files of the shards.");
+  if (o.command == "store" && (o.out.empty() || o.inputs.size() != 1)) throw std::invalid_argument("Need --out and one file of profiles.");
+  if (o.command != "run" && o.command != "merge" && o.command != "store") {
+    throw std::invalid_argument("Unknown command " + o.command + "; use run, merge or store.");
+  }
+  if (o.command == "run" && !o.inputs.empty()) throw std::invalid_argument("Unexpected argument " + o.inputs[0] + ".");
+  return o;
+}
+
+std::string relative_to(const std::string& file, const std::string& name) {
+  if (name.empty() || name[0] == '/') return name;
+  const std::size_t slash = file.find_last_of('/');
+  return slash == std::string::npos ? name : file.substr(0, slash + 1) + name;
+}
+
+job read_job(const std::string& file) {
+  std::ifstream in(file);
+  if (!in) throw std::invalid_argument("Cannot open " + file + ".");
+  job j;
+  j.M = 0;
+  j.N = 0;
+  j.SVR = 1;
+  std::map<std::string, tv* > fields = {{"yt", &j.yt}, {"LPx", &j.LPx}};
+  std::string line;
+  while (std::getline(in, line)) {
+    std::stringstream ls(line);
+    std::string key;
+    if (!(ls >> key) || key[0] == '#') continue;
+    if (key == "model") ls >> j.model;
+    else if (key == "dist") ls >> j.dist;
+    else if (key == "M") ls >> j.M;
+    else if (key == "N") ls >> j.N;
+    else if (key == "SVR") ls >> j.SVR;
+    else if (key == "parameters") {ls >> j.parameters; j.parameters = relative_to(file, j.parameters);}
+    else if (key == "exposure") {ls >> j.exposure; j.exposure = relative_to(file, j.exposure);}
+    else if (fields.count(key)) {
+      double v;
+      while (ls >> v) fields[key]->push_back(v);
+    } else {
+      throw std::invalid_argument("Unknown field " + key + " in " + file + ".");
+    }
+  }
+  if (j.parameters.empty() || j.exposure.empty()) throw std::invalid_argument("Job needs the fields parameters and exposure.");
+  if (j.yt.size() < 2) throw std::invalid_argument("Job needs at least 2 survival time points (yt).");
+  return j;
+}
+
+/// parameter sets, one per line, separated by white space or commas
+std::vector<tv > read_parameters(const std::string& file) {
+  std::ifstream in(file);
+  if (!in) throw std::invalid_argument("Cannot open " + file + ".");
+  std::vector<tv > pars;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::stringstream ls(line);
+    tv par;
+    std::string item;
+    while (ls >> item) {
+      if (item[0] == '#') break;
+      par.push_back(std::stod(item));
+    }
+    if (par.empty()) continue;
+    if (!pars.empty() && par.size() != pars[0].size()) {
+      throw std::invalid_argument("All parameter sets in " + file + " need the same number of values.");
+    }
+    pars.push_back(par);
+  }
+  if (pars.empty()) throw std::invalid_argument("No parameter sets in " + file + ".");
+  return pars;
+}
+
+template<typename TD_mod >
+using span_projector = guts_projector<guts_RED<value_span, value_span, TD_mod, tv >, value_span, tv >;
+template<typename TD_mod >
+using span_fast_projector = guts_projector_fastIT<guts_RED<value_span, value_span, TD_mod, tv >, value_span, tv >;
+
+struct no_setup {
+  template<typename tProjector >
+  void operator()(tProjector&) const {}
+};
+
+/**
+ * projects the items from first to end with one profile projector per parameter set
+ * \param[out] out T + X values per item
+ */
+template<typename tProjector, typename tData >
+void project_items(const tData& dat, const std::vector<tv >& pars, const exposure_profiles& profiles,
+    const job& j, const std::size_t threads, const std::uint64_t first, const std::uint64_t end, tv& out) {
+  const std::uint64_t Q = profiles.size();
+  const std::size_t T = j.yt.size();
+  const std::size_t X = j.LPx.size();
+  out.assign((end - first) * (T + X), 0.0);
+  tv S, LPx;
+  for (std::uint64_t k = first; k < end; ) {
+    const std::uint64_t p = k / Q;
+    const std::uint64_t q0 = k % Q;
+    const std::uint64_t q1 = std::min<std::uint64_t >(Q, q0 + (end - k));
+    const std::size_t n = static_cast<std::size_t >(q1 - q0);
+    // profiles q0 to q1 - 1, offsets relative to the concatenated values
+    const exposure_profiles part(profiles.Ct, profiles.C, profiles.offsets + q0, n);
+    guts_profile_projector<tProjector, tData > proj;
+    proj.set_num_threads(threads);
+    proj.initialize(dat, pars[p], no_setup());
+    S.assign(n * T, 0.0);
+    LPx.assign(n * X, 0.0);
+    proj.project(part, j.LPx, S.data(), LPx.data());
+    for (std::size_t i = 0; i < n; ++i) {
+      double* item = out.data() + (k - first + i) * (T + X);
+      for (std::size_t t = 0; t < T; ++t) item[t] = S[i + t * n];
+      for (std::size_t x = 0; x < X; ++x) item[T + x] = LPx[i + x * n];
+    }
+    k += n;
+  }
+}
+
+/// inserts the unused killing rate of IT models with a threshold distribution
+std::vector<tv > IT_parameters(const std::vector<tv >& pars) {
+  std::vector<tv > res;
+  for (const auto& par : pars) {
+    if (par.size() != 4) throw std::invalid_argument("IT: Need parameters hb, kd and two threshold parameters.");
+    res.push_back({par[0], par[1], std::numeric_limits<double >::quiet_NaN(), par[2], par[3]});
+  }
+  return res;
+}
+
+void check_size(const std::vector<tv >& pars, const std::size_t n, const char* message) {
+  if (pars[0].size() != n) throw std::invalid_argument(message);
+}
+
+void run_job(const job& j, const std::vector<tv >& pars, const exposure_profiles& profiles,
+    const std::size_t threads, const std::uint64_t first, const std::uint64_t end, tv& out) {
+  const value_span yt(j.yt.data(), j.yt.size());
+  const value_span Ct0 = profiles.times(0);
+  const value_span C0 = profiles.concentrations(0);
+  if (j.model == "SD") {
+    check_size(pars, 4, "SD: Need parameters hb, kd, kk and mn.");
+    external_data<value_span, value_span, true, false > dat;
+    dat.set_data(Ct0, C0, yt, j.M, j.SVR);
+    project_items<span_projector<TD_SD > >(dat, pars, profiles, j, threads, first, end, out);
+  } else if (j.model == "IT") {
+    const std::vector<tv > par_IT = IT_parameters(pars);
+    external_data<value_span, value_span, false, false > dat;
+    dat.set_data(Ct0, C0, yt, j.SVR);
+    if (j.dist == "lognormal") project_items<span_fast_projector<TD_IT_lognormal > >(dat, par_IT, profiles, j, threads, first, end, out);
+    else if (j.dist == "loglogistic") project_items<span_fast_projector<TD_IT_loglogistic > >(dat, par_IT, profiles, j, threads, first, end, out);
+    else throw std::invalid_argument("IT: dist must be lognormal or loglogistic.");
+  } else if (j.model == "Proper") {
+    if (j.dist == "delta") {
+      check_size(pars, 4, "Proper-delta: Need parameters hb, kd, kk and mn.");
+      external_data<value_span, value_span, true, false > dat;
+      dat.set_data(Ct0, C0, yt, j.M, j.SVR);
+      project_items<span_projector<TD_proper_delta > >(dat, pars, profiles, j, threads, first, end, out);
+      return;
+    }
+    check_size(pars, 5, "Proper: Need parameters hb, kd, kk and two threshold parameters.");
+    external_data<value_span, value_span, true, true > dat;
+    dat.set_data(Ct0, C0, yt, j.M, j.N, j.SVR);
+    if (j.dist == "lognormal") project_items<span_projector<TD_proper_lognormal > >(dat, pars, profiles, j, threads, first, end, out);
+    else if (j.dist == "loglogistic") project_items<span_projector<TD_proper_loglogistic > >(dat, pars, profiles, j, threads, first, end, out);
+    else throw std::invalid_argument("Proper: dist must be lognormal, loglogistic or delta.");
+  } else {
+    throw std::invalid_argument("model must be SD, IT or Proper.");
+  }
+}
+
+void write_u64(std::ostream& out, const std::uint64_t v) {out.write(reinterpret_cast<const char* >(&v), sizeof(v));}
+void write_doubles(std::ostream& out, const double* v, const std::size_t n) {
+  out.write(reinterpret_cast<const char* >(v), static_cast<std::streamsize >(n * sizeof(double)));
+}
+
+void write_binary(const std::string& file, const result_header& h, const tv& values) {
+  std::ofstream out(file.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("Cannot open '" + file + "' for writing.");
+  out.write(magic, sizeof(magic));
+  out.write(reinterpret_cast<const char* >(&version), sizeof(version));
+  out.write(reinterpret_cast<const char* >(&byte_order_mark), sizeof(byte_order_mark));
+  for (auto v : {h.K, h.Q, h.first, h.end, h.T, h.X}) write_u64(out, v);
+  write_doubles(out, h.yt.data(), h.yt.size());
+  write_doubles(out, h.LPx.data(), h.LPx.size());
+  write_doubles(out, values.data(), values.size());
+  out.close();
+  if (!out) throw std::runtime_error("Cannot write '" + file + "'.");
+}
+
+void write_csv(std::FILE* out, const result_header& h, const tv& values) {
+  std::fprintf(out, "parameter_set,profile");
+  for (auto t : h.yt) std::fprintf(out, ",S_%g", t);
+  for (auto x : h.LPx) std::fprintf(out, ",LP%g", x);
+  std::fprintf(out, "\n");
+  const std::uint64_t V = h.values_per_item();
+  for (std::uint64_t k = h.first; k < h.end; ++k) {
+    std::fprintf(out, "%llu,%llu", static_cast<unsigned long long >(k / h.Q + 1), static_cast<unsigned long long >(k % h.Q + 1));
+    const double* item = values.data() + (k - h.first) * V;
+    for (std::uint64_t v = 0; v < V; ++v) std::fprintf(out, ",%.17g", item[v]);
+    std::fprintf(out, "\n");
+  }
+}
+
+void write_result(const options& o, const result_header& h, const tv& values) {
+  if (!o.csv) {
+    if (o.out.empty()) throw std::invalid_argument("Binary results need --out.");
+    write_binary(o.out, h, values);
+    return;
+  }
+  if (o.out.empty()) {
+    write_csv(stdout, h, values);
+    return;
+  }
+  std::FILE* out = std::fopen(o.out.c_str(), "w");
+  if (!out) throw std::runtime_error("Cannot open '" + o.out + "' for writing.");
+  write_csv(out, h, values);
+  if (std::fclose(out) != 0) throw std::runtime_error("Cannot write '" + o.out + "'.");
+}
+
+void read_binary(const std::string& file, result_header& h, tv& values) {
+  std::ifstream in(file.c_str(), std::ios::binary);
+  if (!in) throw std::runtime_error("Cannot open '" + file + "'.");
+  char file_magic[8];
+  std::uint32_t file_version, bom;
+  in.read(file_magic, sizeof(file_magic));
+  in.read(reinterpret_cast<char* >(&file_version), sizeof(file_version));
+  in.read(reinterpret_cast<char* >(&bom), sizeof(bom));
+  if (!in || std::memcmp(file_magic, magic, sizeof(magic)) != 0) throw std::runtime_error("'" + file + "' is no batch result.");
+  if (file_version != version) throw std::runtime_error("'" + file + "' has unsupported version " + std::to_string(file_version) + ".");
+  if (bom != byte_order_mark) throw std::runtime_error("'" + file + "' was written with a different byte order.");
+  for (auto v : {&h.K, &h.Q, &h.first, &h.end, &h.T, &h.X}) in.read(reinterpret_cast<char* >(v), sizeof(std::uint64_t));
+  if (!in || h.first > h.end || h.end > h.K) throw std::runtime_error("'" + file + "' has an invalid header.");
+  h.yt.resize(h.T);
+  h.LPx.resize(h.X);
+  values.resize((h.end - h.first) * h.values_per_item());
+  in.read(reinterpret_cast<char* >(h.yt.data()), static_cast<std::streamsize >(h.T * sizeof(double)));
+  in.read(reinterpret_cast<char* >(h.LPx.data()), static_cast<std::streamsize >(h.X * sizeof(double)));
+  in.read(reinterpret_cast<char* >(values.data()), static_cast<std::streamsize >(values.size() * sizeof(double)));
+  if (!in || in.peek() != std::char_traits<char >::eof()) throw std::runtime_error("'" + file + "' is truncated or corrupt.");
+}
+
+void run(const options& o) {
+  const job j = read_job(o.job);
+  const std::vector<tv > pars = read_parameters(j.parameters);
+  const mapped_exposure_store store(j.exposure);
+  const exposure_profiles& profiles = store.profiles();
+  if (profiles.size() == 0) throw std::invalid_argument("Need at least one exposure profile.");
+  profiles.check(value_span(j.yt.data(), j.yt.size()));
+
+  result_header h;
+  h.Q = profiles.size();
+  h.K = pars.size() * h.Q;
+  h.first = h.K * o.shard / o.num_shards;
+  h.end = h.K * (o.shard + 1) / o.num_shards;
+  h.T = j.yt.size();
+  h.X = j.LPx.size();
+  h.yt = j.yt;
+  h.LPx = j.LPx;
+  tv values;
+  if (h.end > h.first) run_job(j, pars, profiles, o.threads, h.first, h.end, values);
+  write_result(o, h, values);
+}
+
+void merge(const options& o) {
+  std::vector<std::pair<result_header, tv > > shards(o.inputs.size());
+  for (std::size_t i = 0; i < o.inputs.size(); ++i) read_binary(o.inputs[i], shards[i].first, shards[i].second);
+  std::sort(shards.begin(), shards.end(),
+    [](const std::pair<result_header, tv >& a, const std::pair<result_header, tv >& b) {return a.first.first < b.first.first;});
+  result_header h = shards[0].first;
+  tv values;
+  for (const auto& s : shards) {
+    const result_header& sh = s.first;
+    if (sh.K != h.K || sh.Q != h.Q || sh.yt != h.yt || sh.LPx != h.LPx) {
+      throw std::invalid_argument("Shards belong to different jobs.");
+    }
+    if (sh.first != h.end && &s != &shards[0]) {
+      throw std::invalid_argument(sh.first < h.end ? "Shards overlap." : "Shards leave a gap.");
+    }
+    h.end = sh.end;
+    values.insert(values.end(), s.second.begin(), s.second.end());
+  }
+  if (h.first != 0 || h.end != h.K) {
+    const std::string range = "items " + std::to_string(h.first) + " to " + std::to_string(h.end) + " of " + std::to_string(h.K);
+    if (!o.allow_partial) throw std::invalid_argument("Shards cover only " + range + "; use --allow-partial to merge them.");
+    std::fprintf(stderr, "Merged %s.\n", range.c_str());
+  }
+  write_result(o, h, values);
+}
+
+void store(const options& o) {
+  std::ifstream in(o.inputs[0]);
+  if (!in) throw std::invalid_argument("Cannot open " + o.inputs[0] + ".");
+  tv Ct, C;
+  std::vector<std::uint64_t > offsets(1, 0);
+  std::string line, name, previous;
+  while (std::getline(in, line)) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::stringstream ls(line);
+    double t, c;
+    if (!(ls >> name) || name[0] == '#') continue;
+    if (!(ls >> t >> c)) throw std::invalid_argument("Cannot parse '" + line + "'.");
+    if (Ct.empty()) previous = name;
+    if (name != previous) {
+      offsets.push_back(Ct.size());
+      previous = name;
+    }
+    Ct.push_back(t);
+    C.push_back(c);
+  }
+  if (Ct.empty()) throw std::invalid_argument("No exposure profiles in " + o.inputs[0] + ".");
+  offsets.push_back(Ct.size());
+  write_exposure_store(o.out, exposure_profiles(Ct.data(), C.data(), offsets.data(), offsets.size() - 1));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  try {
+    const options o = parse_options(argc, argv);
+    if (o.command == "run") run(o);
+    else if (o.command == "merge") merge(o);
+    else store(o);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,307 @@
+/**
+ * GUTS: Fast Calculation of the Likelihood of a Stochastic Survival Model.
+ * Accuracy versus cost of time discretization M, sample size N and solver.
+ * License GPL-2
+ * 2026-10-19
+ *
+ * Usage: guts_frontier --data FILE [--tol 0.01] [--M 100,200,...] [--N 50,100,...]
+ *   [--reference-M M] [--reference-N N] [--repeats 5] [--format csv|json]
+ *
+ * The data file holds one field per line, a key followed by its values:
+ *   model Proper        (SD, IT or Proper)
+ *   dist lognormal      (lognormal or loglogistic; not used for SD)
+ *   Ct 0 1 2 ...
+ *   C 4 2 4 ...
+ *   yt 0 1 2 ...
+ *   y 100 90 80 ...
+ *   par 0.01 0.5 0.3 4 0.5   (as in R: hb, kd, [kk,] threshold parameters)
+ *   SVR 1               (optional)
+ * Lines starting with # are ignored.
+ *
+ * The reference is projected with the exact solver if there is one (closed form for
+ * constant exposure, damage maxima for IT with a threshold CDF) and otherwise on a grid
+ * with reference-M and reference-N (default 4 times the largest M and N of the sweep).
+ * All settings of all applicable solvers are timed (median of repeats projections,
+ * including parameterization) and compared to the reference. A setting is on the Pareto
+ * frontier if no faster setting has a smaller loglikelihood error. The recommendation is
+ * the fastest setting with a loglikelihood error of at most tol.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "GUTS_RED.h"
+#include "external_data.h"
+
+typedef std::vector<double > tv;
+typedef external_data<tv, tv, true, true > tdata;
+
+// smallest valid settings for solvers that do not use M or N
+const std::size_t unused_N = 3;
+
+namespace {
+
+struct options {
+  std::string data;
+  double tol;
+  std::vector<std::size_t > M, N;
+  std::size_t reference_M, reference_N;
+  std::size_t repeats;
+  bool json;
+};
+
+struct study {
+  std::string model, dist;
+  tv Ct, C, yt, y, par;
+  double SVR;
+};
+
+/// one setting of a solver
+struct candidate {
+  std::string solver;
+  std::size_t M, N;
+  std::function<tv() > project;
+};
+
+struct result {
+  candidate c;
+  double seconds, LL, LL_error, S_error;
+  bool frontier, recommended;
+};
+
+template<typename T >
+std::vector<T > parse_list(const std::string& s) {
+  std::vector<T > values;
+  std::stringstream ss(s);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    std::stringstream is(item);
+    T v;
+    if (!(is >> v)) throw std::invalid_argument("Cannot parse '" + item + "'.");
+    values.push_back(v);
+  }
+  return values;
+}
+
+options parse_options(int argc, char** argv) {
+  options o;
+  o.tol = 0.01;
+  o.M = {100, 200, 500, 1000, 2000, 5000, 10000, 20000};
+  o.N = {50, 100, 200, 500, 1000, 2000, 5000};
+  o.reference_M = 0;
+  o.reference_N = 0;
+  o.repeats = 5;
+  o.json = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + arg + ".");
+    const std::string value = argv[++i];
+    if (arg == "--data") o.data = value;
+    else if (arg == "--tol") o.tol = std::stod(value);
+    else if (arg == "--M") o.M = parse_list<std::size_t >(value);
+    else if (arg == "--N") o.N = parse_list<std::size_t >(value);
+    else if (arg == "--reference-M") o.reference_M = std::stoul(value);
+    else if (arg == "--reference-N") o.reference_N = std::stoul(value);
+    else if (arg == "--repeats") o.repeats = std::max<std::size_t >(std::stoul(value), 1);
+    else if (arg == "--format") o.json = value == "json";
+    else throw std::invalid_argument("Unknown option " + arg + ".");
+  }
+  if (o.data.empty()) throw std::invalid_argument("Need a data file (--data).");
+  if (o.M.empty() || o.N.empty()) throw std::invalid_argument("Need at least one M and one N.");
+  if (o.reference_M == 0) o.reference_M = 4 * *std::max_element(o.M.begin(), o.M.end());
+  if (o.reference_N == 0) o.reference_N = 4 * *std::max_element(o.N.begin(), o.N.end());
+  return o;
+}
+
+study read_study(const std::string& file) {
+  std::ifstream in(file);
+  if (!in) throw std::invalid_argument("Cannot open " + file + ".");
+  study s;
+  s.SVR = 1;
+  std::map<std::string, tv* > fields = {{"Ct", &s.Ct}, {"C", &s.C}, {"yt", &s.yt}, {"y", &s.y}, {"par", &s.par}};
+  std::string line;
+  while (std::getline(in, line)) {
+    std::stringstream ls(line);
+    std::string key;
+    if (!(ls >> key) || key[0] == '#') continue;
+    if (key == "model") ls >> s.model;
+    else if (key == "dist") ls >> s.dist;
+    else if (key == "SVR") ls >> s.SVR;
+    else if (fields.count(key)) {
+      double v;
+      while (ls >> v) fields[key]->push_back(v);
+    } else {
+      throw std::invalid_argument("Unknown field " + key + " in " + file + ".");
+    }
+  }
+  if (s.y.size() != s.yt.size()) throw std::invalid_argument("Need one number of survivors per survival time.");
+  return s;
+}
+
+tdata make_data(const study& s, const std::size_t M, const std::size_t N) {
+  tdata dat;
+  dat.set_data(s.Ct, s.C, s.yt, M, N, s.SVR);
+  return dat;
+}
+
+template<typename tProjector, typename tData >
+std::function<tv() > make_projection(const tData& dat, const tv& par) {
+  std::shared_ptr<tProjector > proj(new tProjector());
+  proj->initialize(dat);
+  return [proj, par]() {return project(*proj, par);};
+}
+
+template<typename TD_mod >
+using grid_projector = guts_projector<guts_RED<tv, tv, TD_mod, tv >, tv, tv >;
+template<typename TD_mod >
+using fast_projector = guts_projector_fastIT<guts_RED<tv, tv, TD_mod, tv >, tv, tv >;
+template<typename TD_mod >
+using closed_form_projector = guts_projector_constant_exposure<guts_RED<tv, tv, TD_mod, tv >, tv, tv >;
+
+/// reference and candidates of a model with a grid solver (SD, Proper)
+template<typename TD_mod >
+void grid_candidates(const study& s, const options& o, const tv& par, const bool uses_N,
+    candidate& reference, std::vector<candidate >& candidates) {
+  const std::vector<std::size_t > Ns = uses_N ? o.N : std::vector<std::size_t >{0};
+  for (auto M : o.M) {
+    for (auto N : Ns) {
+      candidates.push_back({"grid", M, N, make_projection<grid_projector<TD_mod > >(make_data(s, M, std::max(N, unused_N)), par)});
+    }
+  }
+  const std::size_t ref_N = uses_N ? o.reference_N : 0;
+  reference = {"grid", o.reference_M, ref_N, make_projection<grid_projector<TD_mod > >(make_data(s, o.reference_M, std::max(ref_N, unused_N)), par)};
+  if (is_constant_exposure(make_data(s, 2, unused_N))) {
+    reference = {"closed_form", 0, ref_N, make_projection<closed_form_projector<TD_mod > >(make_data(s, 2, std::max(ref_N, unused_N)), par)};
+    candidates.push_back(reference);
+    if (uses_N) {
+      for (auto N : o.N) {
+        candidates.push_back({"closed_form", 0, N, make_projection<closed_form_projector<TD_mod > >(make_data(s, 2, N), par)});
+      }
+    }
+  }
+}
+
+/// reference and candidates of IT: threshold CDF or importance sample, at damage maxima or on a grid
+template<typename TD_CDF, typename TD_imp >
+void IT_candidates(const study& s, const options& o, const tv& par, candidate& reference, std::vector<candidate >& candidates) {
+  reference = {"fastIT_CDF", 0, 0, make_projection<fast_projector<TD_CDF > >(make_data(s, 2, unused_N), par)};
+  candidates.push_back(reference);
+  for (auto N : o.N) {
+    candidates.push_back({"fastIT_imp", 0, N, make_projection<fast_projector<TD_imp > >(make_data(s, 2, N), par)});
+  }
+  for (auto M : o.M) {
+    candidates.push_back({"grid_CDF", M, 0, make_projection<grid_projector<TD_CDF > >(make_data(s, M, unused_N), par)});
+    for (auto N : o.N) {
+      candidates.push_back({"grid_imp", M, N, make_projection<grid_projector<TD_imp > >(make_data(s, M, N), par)});
+    }
+  }
+}
+
+void make_candidates(const study& s, const options& o, candidate& reference, std::vector<candidate >& candidates) {
+  if (s.model == "SD") {
+    if (s.par.size() != 4) throw std::invalid_argument("SD: Need parameters hb, kd, kk and mn.");
+    grid_candidates<TD_SD >(s, o, s.par, false, reference, candidates);
+  } else if (s.model == "IT") {
+    if (s.par.size() != 4) throw std::invalid_argument("IT: Need parameters hb, kd and two threshold parameters.");
+    const tv par = {s.par[0], s.par[1], std::numeric_limits<double >::quiet_NaN(), s.par[2], s.par[3]};
+    if (s.dist == "lognormal") IT_candidates<TD_IT_lognormal, TD_IT_imp_lognormal >(s, o, par, reference, candidates);
+    else if (s.dist == "loglogistic") IT_candidates<TD_IT_loglogistic, TD_IT_imp_loglogistic >(s, o, par, reference, candidates);
+    else throw std::invalid_argument("IT: dist must be lognormal or loglogistic.");
+  } else if (s.model == "Proper") {
+    if (s.par.size() != 5) throw std::invalid_argument("Proper: Need parameters hb, kd, kk and two threshold parameters.");
+    if (s.dist == "lognormal") grid_candidates<TD_proper_lognormal >(s, o, s.par, true, reference, candidates);
+    else if (s.dist == "loglogistic") grid_candidates<TD_proper_loglogistic >(s, o, s.par, true, reference, candidates);
+    else throw std::invalid_argument("Proper: dist must be lognormal or loglogistic.");
+  } else {
+    throw std::invalid_argument("model must be SD, IT or Proper.");
+  }
+}
+
+/// median time of repeats projections in seconds
+double time_projection(const candidate& c, const std::size_t repeats) {
+  std::vector<double > seconds(repeats);
+  for (auto& t : seconds) {
+    const auto start = std::chrono::steady_clock::now();
+    const tv p = c.project();
+    t = std::chrono::duration<double >(std::chrono::steady_clock::now() - start).count();
+  }
+  std::sort(seconds.begin(), seconds.end());
+  return seconds[seconds.size() / 2];
+}
+
+double max_abs_difference(const tv& a, const tv& b) {
+  double d = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) d = std::max(d, std::fabs(a[i] - b[i]));
+  return d;
+}
+
+std::string field(const std::size_t v, const char* none) {return v == 0 ? std::string(none) : std::to_string(v);}
+
+void print(const std::vector<result >& results, const options& o, const double LL_reference) {
+  if (!o.json) std::printf("solver,M,N,seconds,LL,LL_error,S_error,frontier,recommended\n");
+  for (const auto& r : results) {
+    if (o.json) {
+      std::printf("{\"solver\":\"%s\",\"M\":%s,\"N\":%s,\"seconds\":%.6g,\"LL\":%.10g,\"LL_error\":%.6g,\"S_error\":%.6g,"
+        "\"frontier\":%s,\"recommended\":%s,\"LL_reference\":%.10g}\n",
+        r.c.solver.c_str(), field(r.c.M, "null").c_str(), field(r.c.N, "null").c_str(), r.seconds, r.LL, r.LL_error, r.S_error,
+        r.frontier ? "true" : "false", r.recommended ? "true" : "false", LL_reference);
+    } else {
+      std::printf("%s,%s,%s,%.6g,%.10g,%.6g,%.6g,%d,%d\n",
+        r.c.solver.c_str(), field(r.c.M, "").c_str(), field(r.c.N, "").c_str(), r.seconds, r.LL, r.LL_error, r.S_error,
+        r.frontier ? 1 : 0, r.recommended ? 1 : 0);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  try {
+    const options o = parse_options(argc, argv);
+    const study s = read_study(o.data);
+    candidate reference;
+    std::vector<candidate > candidates;
+    make_candidates(s, o, reference, candidates);
+
+    const tv S_reference = reference.project();
+    const double LL_reference = calculate_loglikelihood(S_reference, s.y);
+    std::vector<result > results;
+    for (const auto& c : candidates) {
+      result r;
+      r.c = c;
+      const tv S = c.project();
+      r.seconds = time_projection(c, o.repeats);
+      r.LL = calculate_loglikelihood(S, s.y);
+      r.LL_error = std::fabs(r.LL - LL_reference);
+      if (std::isnan(r.LL_error)) r.LL_error = std::numeric_limits<double >::infinity();
+      r.S_error = max_abs_difference(S, S_reference);
+      r.frontier = false;
+      r.recommended = false;
+      results.push_back(r);
+    }
+    std::sort(results.begin(), results.end(), [](const result& a, const result& b) {return a.seconds < b.seconds;});
+    double best_error = std::numeric_limits<double >::infinity();
+    bool recommended = false;
+    for (auto& r : results) {
+      r.frontier = r.LL_error < best_error;
+      best_error = std::min(best_error, r.LL_error);
+      if (!recommended && r.LL_error <= o.tol) r.recommended = recommended = true;
+    }
+    print(results, o, LL_reference);
+    if (!recommended) std::fprintf(stderr, "No setting reaches a loglikelihood error of %g.\n", o.tol);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}